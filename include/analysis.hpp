@@ -0,0 +1,114 @@
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "coverage.hpp"
+#include "disassembly_cache.hpp"
+#include "rom.hpp"
+
+namespace qtboy
+{
+
+// What is known about a ROM's code, kept from one session to the next: the entry points the
+// disassembler decoded from, the code/data map (see Coverage) and labels, named by the user
+// or imported from a .sym file. Loading it lets the debugger list the code of a large ROM
+// right away instead of finding it again by running it.
+//
+// Files are keyed by the ROM's header checksum (014e-014f) and title, see file_name().
+class Analysis
+{
+    public:
+    // A labelled address. bank is 0 for 0000-3fff, the ROM bank for 4000-7fff, and the
+    // VRAM, cartridge RAM or WRAM bank for RAM.
+    struct Label
+    {
+        uint16_t bank, adr;
+        std::string name;
+    };
+
+    // An empty analysis of rom.
+    explicit Analysis(const Rom &rom);
+
+    // The header checksum of rom.
+    static uint16_t checksum(const Rom &rom);
+
+    // The file name to save the analysis of rom under, such as "TETRIS-0a16.analysis".
+    static std::string file_name(const Rom &rom);
+
+    // True if this is an analysis of rom (same checksum, title and size).
+    bool matches(const Rom &rom) const;
+
+    uint16_t checksum() const { return checksum_; }
+    const std::string &title() const { return title_; }
+
+    void set_entries(std::vector<Disassembly_cache::Entry> e) { entries_ = std::move(e); }
+    const std::vector<Disassembly_cache::Entry> &entries() const { return entries_; }
+
+    Coverage &coverage() { return coverage_; }
+    const Coverage &coverage() const { return coverage_; }
+
+    // Name bank:adr, replacing its label if it had one. An empty name removes the label.
+    void set_label(uint16_t bank, uint16_t adr, const std::string &name);
+
+    // The label of bank:adr, nullptr if there is none. bank is ignored below 4000.
+    const std::string *label(uint16_t bank, uint16_t adr) const;
+
+    // Every label, in bank and address order.
+    std::vector<Label> labels() const;
+
+    // Add the labels of a .sym file as written by RGBDS and read by BGB: one
+    // "bank:address name" line per label in hex, such as "01:4a3f Main_loop", and comments
+    // starting with ';'. Returns the number of labels read. Throws std::runtime_error if the
+    // file can't be read or a line can't be parsed, before adding any.
+    std::size_t import_sym(const std::string &path);
+
+    // Write everything to a file. Throws std::runtime_error if it can't be written.
+    void save(const std::string &path) const;
+
+    // Replace everything with a file written by save(). Throws std::runtime_error if the
+    // file can't be read or is the analysis of another ROM, leaving this one unchanged.
+    void load(const std::string &path);
+
+    private:
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint16_t checksum;
+        uint16_t reserved;
+        uint32_t rom_banks;
+        uint32_t entries;
+        uint32_t labels;
+        std::array<char, 16> title;
+    };
+
+    struct Label_header
+    {
+        uint16_t bank, adr, length;
+    };
+
+    static constexpr std::array<char, 8> MAGIC {{'Q', 'T', 'B', 'A', 'N', 'L', 'Y', 'S'}};
+    static constexpr uint32_t VERSION {1};
+
+    static uint32_t key(uint16_t bank, uint16_t adr)
+    {
+        return static_cast<uint32_t>(adr < 0x4000 ? 0 : bank) << 16 | adr;
+    }
+
+    uint16_t checksum_;
+    std::string title_;
+    std::size_t rom_banks_;
+    std::vector<Disassembly_cache::Entry> entries_ {};
+    Coverage coverage_;
+    // names by key()
+    std::map<uint32_t, std::string> labels_ {};
+};
+
+}
+
+#endif // ANALYSIS_HPP
@@ -31,8 +31,13 @@ class Apu
 
     // Set the speaker used for audio output.
     void set_speaker(std::shared_ptr<Speaker> s);
+    const std::shared_ptr<Speaker> &speaker() const { return speaker_; }
     void reset();
 
+    // Copy the registers and channel state of another APU. The speaker is kept and samples
+    // not yet pushed to it are dropped.
+    void copy_state(const Apu &other);
+
     // When disabled, all samples are reduced to 0 before being pushed to speaker.
     void toggle_sound(bool b);
 
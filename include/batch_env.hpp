@@ -0,0 +1,112 @@
+#ifndef BATCH_ENV_HPP
+#define BATCH_ENV_HPP
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "executor.hpp"
+#include "graphic_types.hpp"
+#include "ppu.hpp"
+
+namespace qtboy
+{
+
+class Gameboy;
+
+// A batch of Gameboys stepped in lockstep for reinforcement learning. Every step takes one
+// action per instance, runs all instances for a number of frames on a worker pool, and
+// writes the last frame and a set of RAM bytes of every instance into contiguous arrays
+// that are allocated once up front (one slice per instance, instance i at offset i * size).
+class Batch_env
+{
+    public:
+    struct Options
+    {
+        // Frames emulated per step. The action is held for all of them.
+        unsigned frame_skip {4};
+        // Probability that an instance repeats its previous action for a frame instead of
+        // taking the new one (sticky actions).
+        double sticky_action_prob {0.0};
+        // Addresses of the RAM bytes observed after every step.
+        std::vector<uint16_t> ram_addresses {};
+        // Worker threads to step instances on. 0 uses one worker per core.
+        unsigned workers {0};
+        // Seed for the sticky action generator of instance i is seed + i.
+        uint64_t seed {0};
+        // Frame format. Rgb fills frames(), Palette_index and Luminance fill
+        // observations() with output_width x output_height bytes per instance instead.
+        Ppu::Output output {Ppu::Output::Rgb};
+        unsigned output_width {160}, output_height {144};
+    };
+
+    static constexpr unsigned FRAME_WIDTH {160};
+    static constexpr unsigned FRAME_HEIGHT {144};
+    static constexpr std::size_t FRAME_SIZE {FRAME_WIDTH * FRAME_HEIGHT};
+
+    // Create k instances, each a clone of start. start must have a ROM loaded and no buttons
+    // held. reset() puts instances back in the state start was in at construction.
+    Batch_env(const Gameboy &start, std::size_t k, Options opt);
+    Batch_env(const Gameboy &start, std::size_t k);
+    Batch_env(const Batch_env &) = delete;
+    Batch_env &operator=(const Batch_env &) = delete;
+    ~Batch_env();
+
+    // Run one step. actions holds size() button masks, bit i of a mask set means
+    // Joypad::Input i is held down for the step.
+    void step(const uint8_t *actions);
+    void step(const std::vector<uint8_t> &actions);
+
+    // Put every instance (or instance i) back in its start state and release all buttons.
+    // The RAM observation is refreshed, the frame is left as it was until the next step.
+    void reset();
+    void reset(std::size_t i);
+
+    // Number of instances.
+    std::size_t size() const;
+
+    // Last frame of every instance, FRAME_SIZE RGB555 colors each, row major. Only filled
+    // with Ppu::Output::Rgb.
+    const Color *frames() const { return frames_.data(); }
+    const Color *frame(std::size_t i) const { return frames_.data() + i * FRAME_SIZE; }
+
+    // Last palette index or luminance frame of every instance, observation_size() bytes each.
+    const uint8_t *observations() const { return observations_.data(); }
+    const uint8_t *observation(std::size_t i) const { return observations_.data() + i * observation_size(); }
+    std::size_t observation_size() const { return opt_.output_width * opt_.output_height; }
+
+    // Observed RAM bytes of every instance, ram_addresses.size() bytes each.
+    const uint8_t *ram() const { return ram_.data(); }
+    const uint8_t *ram(std::size_t i) const { return ram_.data() + i * opt_.ram_addresses.size(); }
+
+    // The instance at i, e.g. for saving its state or hashing it.
+    Gameboy &instance(std::size_t i) { return *instances_[i]; }
+
+    private:
+    // Renders an instance's frame straight into its slice of frames_.
+    class Frame_capture;
+
+    // Press and release buttons so instance i holds down exactly the buttons in mask.
+    void apply(std::size_t i, uint8_t mask);
+
+    // Copy the observed RAM bytes (and 8-bit frame) of instance i into its slices of ram_
+    // (and observations_).
+    void observe(std::size_t i);
+
+    private:
+    Options opt_;
+    std::unique_ptr<Gameboy> start_;
+    std::vector<std::shared_ptr<Gameboy>> instances_ {};
+    std::vector<std::unique_ptr<Frame_capture>> captures_ {};
+    std::vector<uint8_t> held_ {}; // buttons currently held by each instance
+    std::vector<std::mt19937_64> rngs_ {};
+    std::vector<Color> frames_ {};
+    std::vector<uint8_t> observations_ {};
+    std::vector<uint8_t> ram_ {};
+    Executor executor_;
+};
+
+}
+
+#endif // BATCH_ENV_HPP
@@ -0,0 +1,75 @@
+#ifndef BREAKPOINTS_HPP
+#define BREAKPOINTS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "condition.hpp"
+
+namespace qtboy
+{
+
+// Breakpoints on instruction addresses, optionally qualified by the bank mapped at the
+// address (ROMX, VRAM, cartridge RAM or WRAM bank). Every address with a breakpoint in any
+// bank has a bit in a 64K bitmap, so the check run before every instruction is a single bit
+// test; the bank and the breakpoint's condition are only looked at when that bit is set.
+class Breakpoints
+{
+    public:
+    // Bank of a breakpoint that triggers whatever bank is mapped.
+    static constexpr int ANY_BANK {-1};
+    // Largest bank a breakpoint can be in: MBC5 has 512 ROM banks, more than any RAM.
+    static constexpr int MAX_BANK {0x1ff};
+
+    struct Breakpoint
+    {
+        uint16_t adr;
+        int bank;
+        std::string condition; // empty if unconditional
+    };
+
+    // Adds a breakpoint, or replaces the condition of the one at adr in bank. The breakpoint
+    // only triggers when condition (see Condition) is true. Throws std::out_of_range if bank
+    // isn't ANY_BANK or 0 to MAX_BANK and std::runtime_error if condition doesn't compile.
+    void add(uint16_t adr, int bank = ANY_BANK, const std::string &condition = {});
+    void remove(uint16_t adr, int bank = ANY_BANK);
+    void clear();
+    bool empty() const;
+
+    // True if a breakpoint in some bank is at adr.
+    bool maybe(uint16_t adr) const { return any_[adr >> 6] >> (adr & 63) & 1; }
+
+    // True if a breakpoint is at adr for the given mapped bank and its condition holds. Only
+    // call if maybe(adr).
+    bool hit(uint16_t adr, uint16_t bank, const Processor &cpu, const Memory &memory) const;
+
+    // Every breakpoint, ordered by bank (ANY_BANK first) and address.
+    std::vector<Breakpoint> list() const;
+
+    private:
+    static bool test(const uint64_t *bits, uint32_t i) { return bits[i >> 6] >> (i & 63) & 1; }
+
+    // Recompute the bit of adr in any_.
+    void update(uint16_t adr);
+
+    // Key of a breakpoint in conditions_.
+    static uint64_t key(uint16_t adr, int bank)
+    {
+        return static_cast<uint64_t>(bank + 1) << 16 | adr;
+    }
+
+    // True if the breakpoint with the given key has no condition or its condition holds.
+    bool holds(uint64_t key, const Processor &cpu, const Memory &memory) const;
+
+    std::array<uint64_t, 0x400> any_ {}; // breakpoint in any bank
+    std::array<uint64_t, 0x400> unbanked_ {}; // ANY_BANK breakpoints
+    std::vector<uint64_t> banked_ {}; // bit bank << 16 | adr, grown as banks are used
+    std::unordered_map<uint64_t, Condition> conditions_ {}; // conditional breakpoints only
+};
+
+}
+
+#endif // BREAKPOINTS_HPP
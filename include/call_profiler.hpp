@@ -0,0 +1,86 @@
+#ifndef CALL_PROFILER_HPP
+#define CALL_PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace qtboy
+{
+
+// Attributes emulated cycles to guest functions. The processor reports every CALL, RST and
+// interrupt entry (enter()) and every RET and RETI (leave()), which are tracked in a shadow
+// call stack. Cycles are charged to the whole stack they were spent in, so the result can be
+// written in the collapsed stack format flame graph tools read. Functions are keyed by the
+// bank:address they were called at, the bank being 0 outside ROMX (4000-7fff).
+//
+// Games don't always return the way they called (e.g. popping the return address and
+// jumping), so returns are matched by stack pointer: a return unwinds every frame whose
+// return address is at or below SP.
+class Call_profiler
+{
+    public:
+    // Calls nested deeper than this are charged to the deepest frame tracked.
+    static constexpr std::size_t MAX_DEPTH {256};
+
+    struct Function
+    {
+        uint16_t bank, adr;
+        uint64_t calls;
+        // cycles spent in the function itself, and including the functions it called
+        uint64_t self_cycles, total_cycles;
+    };
+
+    // Called by the processor. sp is the stack pointer with the return address pushed (enter)
+    // or not yet popped (leave), cycles the processor's cycle count.
+    void enter(uint16_t bank, uint16_t adr, uint16_t sp, uint32_t cycles);
+    void leave(uint16_t sp, uint32_t cycles);
+
+    // Charge the cycles up to now to the current stack. The first call only starts counting.
+    void sync(uint32_t cycles);
+
+    // Drop the call stack and count on from cycles, after the processor's state was replaced.
+    void restart(uint32_t cycles);
+
+    void clear();
+
+    // Every function called, most self cycles first.
+    std::vector<Function> functions() const;
+
+    // Write one "frame;frame;... cycles" line per stack cycles were spent in, outermost frame
+    // first. Frames are bank:address in hex, cycles spent outside any call are under [root].
+    void write_collapsed(std::ostream &os) const;
+
+    private:
+    struct Node
+    {
+        uint32_t key; // bank << 16 | address
+        uint32_t parent;
+        uint64_t calls;
+        uint64_t self;
+    };
+
+    struct Frame
+    {
+        uint32_t node;
+        uint16_t sp;
+    };
+
+    void charge(uint32_t cycles);
+
+    // nodes_[0] is the root, children always come after their parent
+    std::vector<Node> nodes_ {{0, 0, 0, 0}};
+    // parent << 32 | key -> child
+    std::unordered_map<uint64_t, uint32_t> children_ {};
+    std::vector<Frame> stack_ {};
+    // node of the current stack
+    uint32_t node_ {0};
+    uint32_t last_cycles_ {0};
+    bool started_ {false};
+};
+
+}
+
+#endif // CALL_PROFILER_HPP
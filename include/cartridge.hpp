@@ -19,9 +19,11 @@ class Cartridge
 {
 	public:
     explicit Cartridge(std::istream &is);
-    Cartridge(const Cartridge &) = delete;
+    explicit Cartridge(Rom rom);
+    // Copies share the ROM image and get their own copy of the RAM and banking state.
+    Cartridge(const Cartridge &other);
     Cartridge(Cartridge &&) = default;
-    Cartridge &operator=(const Cartridge &) = delete;
+    Cartridge &operator=(const Cartridge &other);
     Cartridge &operator=(Cartridge &&) = default;
     ~Cartridge() = default;
 
@@ -31,8 +33,22 @@ class Cartridge
     std::unordered_map<std::string, Memory_range> dump() const;
     std::vector<uint8_t> dump_rom() const;
     std::vector<uint8_t> dump_ram() const;
+    // The byte dump() shows at adr (0000-7fff, a000-bfff), without copying its bank.
+    uint8_t dump_byte(uint16_t adr) const;
     bool is_cgb() const;
     std::string title() const;
+    // ROM bank currently mapped at 4000-7fff.
+    uint16_t rom_bank() const;
+    // RAM bank currently mapped at a000-bfff.
+    uint8_t ram_bank() const;
+    // True if the cartridge has RAM.
+    bool has_ram() const { return ram_.has_value(); }
+    // The cartridge RAM, nullptr if there is none. Unlike dump_ram() it's there without a
+    // battery too.
+    const External_ram *ram() const { return ram_ ? &*ram_ : nullptr; }
+
+    // The (shared, read-only) ROM image this cartridge runs from.
+    const Rom &rom() const { return rom_; }
 	
 	private:
     Rom rom_;
@@ -0,0 +1,75 @@
+#ifndef CONDITION_HPP
+#define CONDITION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qtboy
+{
+
+class Processor;
+class Memory;
+
+// A breakpoint or watchpoint condition such as "A == 0x3c && [0xd158] > 5 && LY == 144",
+// compiled once into stack bytecode and evaluated against the CPU and memory when its
+// breakpoint or watchpoint triggers.
+//
+// Operands:
+//   A F B C D E H L AF BC DE HL SP PC  registers
+//   ZF NF HF CF                        flags (0 or 1)
+//   IME                                interrupt master enable (0 or 1)
+//   LY                                 FF44
+//   BANK                               bank mapped at PC (see Memory::bank())
+//   [expr]                             the byte at address expr
+//   123, 0x7b, $7b, 0b1111011          numbers
+// Operators, by decreasing precedence, as in C: unary ! ~ -, * / %, + -, << >>,
+// < <= > >=, == !=, &, ^, |, &&, ||, and parentheses. Names are case-insensitive.
+// Arithmetic is on 32-bit integers, division by zero gives 0.
+class Condition
+{
+    public:
+    // An empty condition, always true.
+    Condition() = default;
+
+    // Compile source, empty if source is blank. Throws std::runtime_error describing the
+    // first syntax error.
+    explicit Condition(const std::string &source);
+
+    bool empty() const { return code_.empty(); }
+    const std::string &source() const { return source_; }
+
+    // Evaluate to true (non-zero) or false. Reading memory has no side effects.
+    bool operator()(const Processor &cpu, const Memory &memory) const;
+
+    private:
+    enum class Op : uint8_t
+    {
+        Push, Register, Load,
+        Not, Complement, Negate,
+        Multiply, Divide, Modulo, Add, Subtract, Shift_left, Shift_right,
+        Less, Less_equal, Greater, Greater_equal, Equal, Not_equal,
+        And, Xor, Or, Logical_and, Logical_or,
+    };
+
+    enum class Operand : uint8_t
+    {
+        A, F, B, C, D, E, H, L, AF, BC, DE, HL, SP, PC, ZF, NF, HF, CF, IME, LY, BANK,
+    };
+
+    struct Instruction
+    {
+        Op op;
+        int32_t value; // number to Push, Operand of Register
+    };
+
+    class Parser;
+
+    std::string source_ {};
+    std::vector<Instruction> code_ {};
+    std::size_t stack_size_ {0};
+};
+
+}
+
+#endif // CONDITION_HPP
@@ -0,0 +1,113 @@
+#ifndef COVERAGE_HPP
+#define COVERAGE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace qtboy
+{
+
+// One bit per byte of every bank:address the CPU fetched as part of an instruction (opcode or
+// operand), and one per byte it read as data, filled in by Processor while set as the
+// processor's coverage (see Gameboy::set_coverage()). Addresses outside ROMX (4000-7fff)
+// are marked under bank 0, whatever is mapped there.
+//
+// Telling code from data this way drives the disassembler (see
+// Disassembler::pretty_disassemble()) and shows which parts of a ROM a run or a movie
+// exercises. Maps can be saved and loaded into another, so coverage accumulates across
+// sessions.
+class Coverage
+{
+    public:
+    // What a byte was used as.
+    enum Kind : uint8_t
+    {
+        Unused = 0,
+        Code = 1,
+        Data = 2,
+        Code_and_data = Code | Data,
+    };
+
+    // Consecutive bytes of one bank used the same way.
+    struct Run
+    {
+        uint16_t bank, first, last; // inclusive
+        Kind kind;
+    };
+
+    // rom_banks is the number of 16 KB banks of the ROM that will be run.
+    explicit Coverage(std::size_t rom_banks);
+
+    // Called by the processor, bank is the ROM bank mapped at 4000-7fff.
+    void mark_code(uint16_t bank, uint16_t adr) noexcept { set(code_, index(bank, adr)); }
+    void mark_data(uint16_t bank, uint16_t adr) noexcept { set(data_, index(bank, adr)); }
+
+    Kind kind(uint16_t bank, uint16_t adr) const;
+
+    // Number of bytes of the given kind.
+    std::size_t count(Kind k) const;
+
+    // Every run of used bytes, in bank and address order.
+    std::vector<Run> runs() const;
+
+    void clear();
+
+    // Add the bytes marked in other, a map for a ROM of the same size, to this map.
+    void merge(const Coverage &other);
+
+    // CSV with a header line and one kind,bank,first,last,bytes line per run (kind code, data
+    // or both).
+    void write_csv(std::ostream &os) const;
+
+    // Write both maps to a file. Throws std::runtime_error if it can't be written.
+    void save(const std::string &path) const;
+    void save(std::ostream &os) const;
+
+    // Add the bytes marked in a file written by save() to this map. Throws
+    // std::runtime_error if the file can't be read or is for a ROM of a different size.
+    void load(const std::string &path);
+    void load(std::istream &is);
+
+    private:
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t words; // 64-bit words in each map
+    };
+
+    static constexpr std::array<char, 8> MAGIC {{'Q', 'T', 'B', 'C', 'O', 'V', 'E', 'R'}};
+    static constexpr uint32_t VERSION {1};
+
+    // Bit index of bank:adr: addresses outside ROMX index directly, ROMX bank b starts at
+    // 0x10000 + b * 0x4000 (see Execution_histogram).
+    uint32_t index(uint16_t bank, uint16_t adr) const noexcept
+    {
+        const uint32_t romx = (adr & 0xc000) == 0x4000;
+        return adr + romx * (0xc000u + (bank & bank_mask_) * 0x4000u);
+    }
+
+    static void set(std::vector<uint64_t> &bits, uint32_t i) noexcept
+    {
+        bits[i >> 6] |= uint64_t {1} << (i & 63);
+    }
+
+    static bool test(const std::vector<uint64_t> &bits, uint32_t i)
+    {
+        return bits[i >> 6] >> (i & 63) & 1;
+    }
+
+    // banks are masked as in Execution_histogram
+    uint16_t bank_mask_;
+    std::vector<uint64_t> code_;
+    std::vector<uint64_t> data_;
+};
+
+}
+
+#endif // COVERAGE_HPP
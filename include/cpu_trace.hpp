@@ -0,0 +1,106 @@
+#ifndef CPU_TRACE_HPP
+#define CPU_TRACE_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qtboy
+{
+
+// A ring of fixed-size binary records, one per executed instruction. Recording an
+// instruction is a copy of 24 bytes, nothing is formatted or written while emulating: the
+// text of a trace (see format()) is produced afterwards, e.g. by tools/trace_format. The
+// ring lives either in memory or in a memory mapped file, which the OS writes back on its
+// own, so a trace of a whole session can go straight to disk.
+//
+// Trace files start with a Header followed by capacity records in ring order. The oldest
+// record is at written % capacity once the ring has wrapped, at 0 before.
+class Cpu_trace
+{
+    public:
+    // CPU state before an instruction executes.
+    struct Record
+    {
+        uint16_t af, bc, de, hl, sp, pc;
+        uint16_t bank; // bank mapped at pc, see Memory::bank()
+        std::array<uint8_t, 3> ops; // bytes at pc
+        uint8_t ly;
+        uint8_t ime;
+        uint8_t reserved;
+        uint32_t cycles; // Processor::cycles()
+    };
+    static_assert(sizeof(Record) == 24, "trace records are stored as is");
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t capacity;
+        uint64_t written; // records recorded since the trace was created or cleared
+    };
+
+    static constexpr std::array<char, 8> MAGIC {{'Q', 'T', 'B', 'T', 'R', 'A', 'C', 'E'}};
+    static constexpr uint32_t VERSION {1};
+
+    // Keep the last capacity records in memory.
+    explicit Cpu_trace(std::size_t capacity);
+
+    // Keep the last capacity records in a file at path, created or truncated, mapped into
+    // memory. Throws std::runtime_error if the file can't be created or mapped.
+    Cpu_trace(const std::string &path, std::size_t capacity);
+
+    Cpu_trace(const Cpu_trace &) = delete;
+    Cpu_trace &operator=(const Cpu_trace &) = delete;
+    ~Cpu_trace();
+
+    void record(const Record &r)
+    {
+        records_[next_] = r;
+        if (++next_ == capacity_)
+            next_ = 0;
+        ++header_->written;
+    }
+
+    // Records currently held, at most capacity().
+    std::size_t size() const;
+    std::size_t capacity() const { return capacity_; }
+    uint64_t written() const { return header_->written; }
+    bool is_mapped() const { return mapping_ != nullptr; }
+
+    // Record i, oldest first (i < size()).
+    const Record &operator[](std::size_t i) const;
+
+    void clear();
+
+    // Write the trace to a file in the same format as a mapped trace. Throws
+    // std::runtime_error if the file can't be written.
+    void save(const std::string &path) const;
+
+    // Read the records of a trace file, oldest first. Throws std::runtime_error if the file
+    // can't be read or isn't a trace.
+    static std::vector<Record> load(const std::string &path);
+
+    // A record as a line of Debugger's CPU log.
+    static std::string format(const Record &r);
+
+    private:
+    std::size_t capacity_;
+    std::size_t next_ {0};
+    Header *header_ {nullptr};
+    Record *records_ {nullptr};
+    // in memory
+    std::unique_ptr<Header> header_storage_ {};
+    std::vector<Record> record_storage_ {};
+    // mapped file
+    void *mapping_ {nullptr};
+    std::size_t mapping_size_ {0};
+};
+
+}
+
+#endif // CPU_TRACE_HPP
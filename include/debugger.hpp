@@ -10,10 +10,14 @@
 #include <atomic>
 #include <memory>
 
+#include "analysis.hpp"
 #include "debug_types.hpp"
 #include "instruction_info.hpp"
 #include "ppu.hpp"
 #include "disassembler.hpp"
+#include "disassembly_cache.hpp"
+#include "breakpoints.hpp"
+#include "watchpoints.hpp"
 
 namespace qtboy
 {
@@ -33,24 +37,46 @@ class Debugger
     // Passed to the system to be called after every CPU instruction.
     bool cpu_callback();
 
-    // Passed to the system to be called after every memory write.
-    void memory_callback(uint8_t b, uint16_t adr);
-
     // Run until a breakpoint is reached (continue).
     void run_until_break();
 
     // Run, ignoring breakpoints.
     void run_no_break();
 
-    // Adds a breakpoint at the specified address (0000h-ffffh)
-    void add_breakpoint(uint16_t);
+    // Adds a breakpoint at the specified address (0000h-ffffh), in a specific bank or in
+    // any bank, with an optional condition (see Gameboy::add_breakpoint()).
+    void add_breakpoint(uint16_t adr, int bank = Breakpoints::ANY_BANK,
+                        const std::string &condition = {});
 
     // Deletes the breakpoint at the specified address. If there is no breakpoint,
     // nothing happens.
-    void delete_breakpoint(uint16_t);
+    void delete_breakpoint(uint16_t adr, int bank = Breakpoints::ANY_BANK);
 
     // Get all currently set breakpoints.
-    const std::unordered_map<uint16_t, bool> &breakpoints() const;
+    std::vector<Breakpoints::Breakpoint> breakpoints() const;
+
+    // Adds a watchpoint on first-last for the given Watchpoints::Access bits (see
+    // Gameboy::add_watchpoint()). Returns its id.
+    int add_watchpoint(uint16_t first, uint16_t last, uint8_t access,
+                       int bank = Watchpoints::ANY_BANK, const std::string &condition = {});
+
+    // Deletes a watchpoint by id. If there is no such watchpoint, nothing happens.
+    void delete_watchpoint(int id);
+
+    // Get all currently set watchpoints.
+    std::vector<Watchpoints::Watchpoint> watchpoints() const;
+
+    // Enables or disables keeping the history step_back() and reverse_continue() need (see
+    // Gameboy::set_history()).
+    void set_reverse_debugging(bool b);
+
+    // Go back to the previous instruction. Returns false if the history doesn't reach back
+    // that far.
+    bool step_back();
+
+    // Go back to the previous breakpoint or watchpoint hit (see Gameboy::reverse_continue()).
+    // Returns false if there is none in the history.
+    bool reverse_continue();
 
     // Sets whether or not a CPU trace is output after every CPU instruction.
     void set_logging(bool b);
@@ -64,8 +90,30 @@ class Debugger
     // Get how many CPU steps have been taken.
     size_t steps() const;
 
-    // Disassemble everything currently mapped in memory.
-    std::vector<Assembly> disassemble() const;
+    // The code found so far in first-last (inclusive) as currently mapped, in address order
+    // (see Disassembly_cache). Code is found from the vectors, the instructions executed
+    // since the last call (see Gameboy::flight_recorder()) and the current PC, and is
+    // decoded once per bank. Only call while the emulator isn't running on another thread.
+    std::vector<Disassembly_cache::Line> disassemble(uint16_t first = 0x0000,
+                                                     uint16_t last = 0xffff) const;
+
+    // The code found so far in a ROM bank, mapped or not.
+    std::vector<Disassembly_cache::Line> disassemble_rom_bank(uint16_t bank) const;
+
+    // What is known about the loaded ROM's code, labels included (see Analysis). Throws
+    // std::runtime_error if no ROM is loaded.
+    Analysis &analysis();
+
+    // Save the entry points found so far, the code/data map (with the system's coverage
+    // added, see Gameboy::set_coverage()) and the labels, to be loaded in another session.
+    // The file is usually named after the ROM (see Analysis::file_name()). Throws
+    // std::runtime_error if no ROM is loaded or the file can't be written.
+    void save_analysis(const std::string &path);
+
+    // Load a file written by save_analysis() for the loaded ROM and decode the code it
+    // lists: its entry points and the start of every run of bytes executed. Throws
+    // std::runtime_error if it can't be read or is the analysis of another ROM.
+    void load_analysis(const std::string &path);
 
     // Reset the debugger and the system.
     void reset();
@@ -74,25 +122,40 @@ class Debugger
     std::vector<uint8_t> dump_memory() const;
     std::string dump_formatted_memory(Dump_format d = Dump_format::Hex) const;
 
+    // Number of rows in dump_formatted_memory(d): 16 bytes per Hex row from 0000 up, one
+    // byte per Stack row from ffff down.
+    static std::size_t memory_rows(Dump_format d = Dump_format::Hex);
+
+    // Format count rows of dump_formatted_memory(d), from row first on, into out, replacing
+    // what it held. Only the memory in those rows is read and out keeps its capacity, so a
+    // view can format just the rows it shows on every refresh.
+    void format_memory_rows(std::size_t first, std::size_t count, std::string &out,
+                            Dump_format d = Dump_format::Hex) const;
+
 
     private:
-    // Generate a CPU trace
+    // Generate a CPU trace line for the next instruction (see Cpu_trace::format())
     std::string log();
 
-    // Check if execution is currently at a breakpoint.
-    bool at_breakpoint();
+    // Bring disassembly_ up to date with the ROM loaded and the code executed.
+    void update_disassembly() const;
 
     private:
     std::shared_ptr<Gameboy> system_ {nullptr};
-    Disassembler disassembler_ {};
-    std::unordered_map<uint16_t, bool> breaks_ {false};
     size_t steps_ {0};
     bool paused_ {false};
+    bool debug_mode_ {false};
     bool logging_ {false};
-    bool breaking_ {true};
     std::ofstream log_file_;
     // memory map cache
     mutable std::unordered_map<std::string, Memory_range> memory_map_ {};
+    // the memory shown by the last format_memory_rows()
+    mutable std::vector<uint8_t> memory_window_ {};
+    // disassembly cache, and the flight recorder count it has seen up to
+    mutable Disassembly_cache disassembly_;
+    mutable uint64_t disassembled_ {0};
+    // analysis of the ROM loaded when analysis() was last called
+    std::unique_ptr<Analysis> analysis_ {};
 };
 
 }
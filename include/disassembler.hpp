@@ -1,7 +1,9 @@
 #ifndef DISASSEMBLER_HPP
 #define DISASSEMBLER_HPP
 
+#include "coverage.hpp"
 #include "debug_types.hpp"
+#include "execution_histogram.hpp"
 
 #include <vector>
 #include <string>
@@ -15,13 +17,27 @@ class Disassembler
 	explicit Disassembler();
 
     static std::string pretty_disassemble(const std::vector<uint8_t> &ops);
+    // Disassemble a whole ROM with the times each instruction was executed in h appended to
+    // its line (bank n starts at offset n * 0x4000).
+    static std::string pretty_disassemble(const std::vector<uint8_t> &rom,
+                                          const Execution_histogram &h);
+    // Disassemble a whole ROM, bytes c only saw read as data as DB lines (bank n starts at
+    // offset n * 0x4000).
+    static std::string pretty_disassemble(const std::vector<uint8_t> &rom, const Coverage &c);
     static std::vector<Assembly> disassemble(const std::vector<uint8_t> &ops);
     static Assembly disassemble_op(const std::array<uint8_t, 3> &ops, size_t adr);
 
+    // Most characters format() writes.
+    static constexpr size_t MAX_TEXT {32};
+
+    // Write the instruction starting with ops, at adr, as text such as "LD   A,($ff44)" into
+    // out, which must have room for MAX_TEXT characters. Returns the number of characters
+    // written, no terminating null is added. Allocates nothing.
+    static size_t format(const std::array<uint8_t, 3> &ops, size_t adr, char *out);
+
     private:
-    class Hex;
-    static std::string parse_operand(const std::array<uint8_t, 3> &next_ops,
-                       const std::string &operand, size_t adr);
+    static std::string pretty_disassemble(const std::vector<uint8_t> &ops,
+                                          const Execution_histogram *h, const Coverage *c);
 };
 	
 }
@@ -0,0 +1,125 @@
+#ifndef DISASSEMBLY_CACHE_HPP
+#define DISASSEMBLY_CACHE_HPP
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rom.hpp"
+
+namespace qtboy
+{
+
+// Disassembly of the code reachable from known entry points (the cartridge entry point, the
+// interrupt vectors, executed PCs), decoded lazily by following jumps and calls and kept per
+// bank, so nothing is decoded twice and switching ROMX costs nothing. Data is never decoded
+// unless something jumps into it.
+//
+// Each ROM bank and each RAM region bank (VRAM, cartridge RAM, WRAM, FE00-FFFF) is a block
+// holding the length of the instruction starting at each address found so far. ROM blocks
+// never change. RAM blocks are dropped when one of their decoded pages is written (see
+// invalidate()), the code there is decoded again from the next entry point found in it.
+class Disassembly_cache
+{
+    public:
+    // A decoded instruction.
+    struct Line
+    {
+        uint16_t adr;
+        uint16_t bank; // see Memory::bank()
+        uint8_t length;
+        std::array<uint8_t, 3> ops; // the instruction's bytes, zero past length
+    };
+
+    // Where decoding started.
+    struct Entry
+    {
+        uint16_t adr;
+        uint16_t bank; // 0 for 0000-3fff
+    };
+
+    // read(adr) reads memory as the CPU sees it, bank(adr) is the bank mapped at adr (see
+    // Memory::bank()). RAM and the banks currently mapped are decoded through them.
+    Disassembly_cache(std::function<uint8_t(uint16_t)> read,
+                      std::function<uint16_t(uint16_t)> bank);
+
+    // Decode ROM banks from rom. Clears the cache if it is a different ROM.
+    void set_rom(const Rom &rom);
+
+    // Decode from adr in the bank mapped there, if it isn't decoded already.
+    void add_entry(uint16_t adr);
+
+    // Decode from adr in ROM bank (bank 0 for 0000-3fff), if it isn't decoded already.
+    void add_entry(uint16_t adr, uint16_t bank);
+
+    // Called after adr is written: drops the RAM block holding adr if any code was decoded
+    // in its page. Only a bit test if there wasn't.
+    void invalidate(uint16_t adr)
+    {
+        if (adr >= 0x8000 && ram_code_pages_[adr >> 8])
+            invalidate_page(adr);
+    }
+
+    // Drop every RAM block, for when memory was written without invalidate() being called.
+    void invalidate_ram();
+
+    // Drop everything.
+    void clear();
+
+    // The instructions decoded in first-last (inclusive) as currently mapped, in address
+    // order.
+    std::vector<Line> lines(uint16_t first = 0x0000, uint16_t last = 0xffff);
+
+    // The instructions decoded in a ROM bank, in address order, whether it's mapped or not.
+    // Bank 0 is at 0000-3fff, the others at 4000-7fff.
+    std::vector<Line> rom_lines(uint16_t bank);
+
+    // The ROM entry points decoding started from, in the order they were found, without
+    // the ones inside code already decoded. Adding them to an empty cache decodes the same
+    // ROM code again.
+    const std::vector<Entry> &rom_entries() const { return rom_entries_; }
+
+    // The line as text, such as "LD   A,($ff44)".
+    static std::string format(const Line &line);
+
+    private:
+    struct Block
+    {
+        uint16_t start; // first address of the region
+        std::vector<uint8_t> lengths; // instruction length at each address, 0 if none
+    };
+
+    // Where a block's bytes come from: a ROM bank, or memory as mapped.
+    enum Region : uint8_t
+    {
+        Rom0, Romx, Vram, Sram, Wram0, Wramx, High, REGIONS
+    };
+
+    static Region region(uint16_t adr);
+    static uint32_t key(Region r, uint16_t bank) { return static_cast<uint32_t>(r) << 16 | bank; }
+
+    Block &block(Region r, uint16_t bank);
+    uint8_t byte(Region r, uint16_t bank, uint16_t adr) const;
+    void decode(uint16_t adr, Region r, uint16_t bank);
+    void seed_vectors();
+    void invalidate_page(uint16_t adr);
+    void mark_page(uint16_t adr);
+    void append_lines(std::vector<Line> &out, Region r, uint16_t bank, uint16_t first,
+                      uint16_t last);
+
+    std::function<uint8_t(uint16_t)> read_;
+    std::function<uint16_t(uint16_t)> bank_;
+    Rom rom_ {};
+    std::unordered_map<uint32_t, Block> blocks_ {};
+    // 256 byte pages of 8000-ffff (indexed by adr >> 8) with decoded code
+    std::bitset<0x100> ram_code_pages_ {};
+    std::vector<Entry> rom_entries_ {};
+};
+
+}
+
+#endif // DISASSEMBLY_CACHE_HPP
@@ -0,0 +1,72 @@
+#ifndef EXECUTION_HISTOGRAM_HPP
+#define EXECUTION_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace qtboy
+{
+
+// Execution counts of every opcode (CB-prefixed ones separately) and every bank:PC, filled in
+// by Processor::step() while set as the processor's histogram. Addresses outside ROMX
+// (4000-7fff) are counted under bank 0, whatever is mapped there.
+class Execution_histogram
+{
+    public:
+    struct Entry
+    {
+        uint16_t bank, adr;
+        uint64_t count;
+    };
+
+    // rom_banks is the number of 16 KB banks of the ROM that will be run.
+    explicit Execution_histogram(std::size_t rom_banks);
+
+    const std::array<uint64_t, 256> &opcodes() const { return ops_; }
+    const std::array<uint64_t, 256> &cb_opcodes() const { return cb_ops_; }
+
+    // Times the instruction at bank:adr was executed.
+    uint64_t count(uint16_t bank, uint16_t adr) const;
+
+    // Instructions executed.
+    uint64_t total() const;
+
+    // Every bank:PC executed at least once, most executed first. At most n entries.
+    std::vector<Entry> hottest(std::size_t n = SIZE_MAX) const;
+
+    void clear();
+
+    // CSV with a header line and one kind,bank,address,opcode,name,count line per opcode
+    // (kind op or cb) and per bank:PC (kind pc) executed. Opcodes are ordered by value,
+    // bank:PCs by count.
+    void write_csv(std::ostream &os) const;
+
+    // JSON object with "opcodes" and "cb_opcodes" (hex opcode to count) and "pcs" (array of
+    // bank, address, count objects ordered by count).
+    void write_json(std::ostream &os) const;
+
+    private:
+    friend class Processor;
+
+    // Index of bank:adr in pcs_: addresses outside ROMX index directly, ROMX bank b starts
+    // at 0x10000 + b * 0x4000. Computed without branching, it runs on every instruction.
+    static uint32_t index(uint16_t bank, uint16_t adr, uint16_t bank_mask)
+    {
+        const uint32_t romx = (adr & 0xc000) == 0x4000;
+        return adr + romx * (0xc000u + (bank & bank_mask) * 0x4000u);
+    }
+
+    std::array<uint64_t, 256> ops_ {};
+    std::array<uint64_t, 256> cb_ops_ {};
+    // banks are masked with bank_mask_ (the ROM's bank count rounded up to a power of two,
+    // minus one), as MBCs ignore the bank bits the ROM doesn't have
+    uint16_t bank_mask_;
+    std::vector<uint64_t> pcs_;
+};
+
+}
+
+#endif // EXECUTION_HISTOGRAM_HPP
@@ -0,0 +1,123 @@
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qtboy
+{
+
+class Gameboy;
+
+// Runs many Gameboys on a fixed pool of worker threads instead of one thread per instance.
+// Instances are stepped cooperatively one frame at a time. Each worker round-robins through
+// its own queue of instances and steals from other workers when its queue runs dry, so every
+// instance advances at the same rate and no core sits idle while others have work queued.
+class Executor
+{
+    public:
+    // Cycles in one frame, the unit of work handed to a worker.
+    static constexpr std::size_t FRAME_CYCLES {70224};
+
+    // Create a pool of worker threads. 0 uses one worker per core.
+    explicit Executor(unsigned workers = 0);
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+    ~Executor();
+
+    // Add an instance to run. The instance must have a ROM loaded, and must not be run on its
+    // own thread (Gameboy::run_concurrently()) while it belongs to the executor. Instances can
+    // only be added while the executor is idle.
+    void add(std::shared_ptr<Gameboy> g);
+
+    // Number of instances added.
+    std::size_t size() const;
+
+    // Number of worker threads.
+    unsigned workers() const;
+
+    // Run every instance for the given number of frames. Blocks until all of them are done.
+    void run_frames(uint64_t frames);
+
+    // Run every instance in the background until stop() is called.
+    void start();
+
+    // Stop running instances started with start(). Blocks until every worker has finished its
+    // current frame.
+    void stop();
+
+    // Frames run by instance i since it was added.
+    uint64_t frames(std::size_t i) const;
+
+    // The exception instance i threw while running, nullptr if it hasn't failed. A failed
+    // instance is retired and not run again; the others keep running.
+    std::exception_ptr error(std::size_t i) const;
+
+    // Frames run by all instances combined.
+    uint64_t total_frames() const;
+
+    // Aggregate frames per second of all instances over the last (or current) run.
+    double frames_per_second() const;
+
+    private:
+    struct Instance
+    {
+        std::shared_ptr<Gameboy> system;
+        std::atomic<uint64_t> frames {0};
+        uint64_t target {0}; // stop rescheduling once frames reaches this
+        std::exception_ptr error {}; // set under mutex_ if running it threw
+    };
+
+    // Instances waiting for a frame slice. Owned by one worker, other workers steal from it.
+    // An instance is in at most one queue at a time, so a ring with room for every instance
+    // never fills and queueing never allocates.
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<std::size_t> slices; // ring of size() instances
+        std::size_t head {0}; // oldest slice
+        std::size_t count {0};
+    };
+
+    // Worker thread main loop.
+    void work(unsigned id);
+
+    // Take the next instance from worker id's queue, or steal one from another queue.
+    bool pop(unsigned id, std::size_t &i);
+    void push(unsigned id, std::size_t i);
+
+    // Queue every instance to run until it has run target more frames.
+    void schedule(uint64_t frames);
+
+    // Block until every scheduled instance has reached its target.
+    void wait();
+
+    private:
+    std::vector<std::unique_ptr<Instance>> instances_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::size_t> runnable_; // scratch for schedule(), sized by add()
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_, done_cv_;
+    std::atomic<std::size_t> queued_ {0}; // slices waiting in queues
+    std::size_t active_ {0}; // instances that haven't reached their target or failed
+    bool exiting_ {false};
+    std::atomic<bool> stopping_ {false};
+
+    std::atomic<uint64_t> total_frames_ {0};
+    uint64_t run_start_frames_ {0};
+    std::chrono::steady_clock::time_point run_start_ {}, run_end_ {};
+    bool running_ {false};
+};
+
+}
+
+#endif // EXECUTOR_HPP
@@ -0,0 +1,101 @@
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace qtboy
+{
+
+// Always-on record of the last INSTRUCTIONS instructions executed and the last IO_WRITES
+// writes to FF00-FFFF, for context when emulation fails (see Gameboy::dump_flight_recorder()).
+// Recording is a few stores into fixed rings, cheap enough to never turn off. The
+// instruction ring is only allocated by allocate(), so a Gameboy that never runs (a clone,
+// a snapshot) doesn't carry it.
+class Flight_recorder
+{
+    public:
+    static constexpr std::size_t INSTRUCTIONS {0x10000};
+    static constexpr std::size_t IO_WRITES {0x400};
+
+    struct Instruction
+    {
+        uint16_t pc;
+        uint16_t bank; // ROM bank at pc, 0 outside 4000-7fff
+        uint16_t sp;
+        uint16_t af;
+        uint8_t opcode;
+    };
+
+    struct Io_write
+    {
+        uint64_t instruction; // number of the instruction that wrote, see instructions()
+        uint16_t pc;
+        uint8_t adr; // low byte of FFxx
+        uint8_t value;
+    };
+
+    Flight_recorder();
+
+    // Allocate the instruction ring, if it isn't already. record() must not be called
+    // before.
+    void allocate();
+    bool allocated() const { return !instructions_.empty(); }
+
+    // Called by the processor before executing an instruction.
+    void record(uint16_t pc, uint16_t bank, uint16_t sp, uint16_t af, uint8_t opcode)
+    {
+        Instruction &i {instructions_[count_ & (INSTRUCTIONS - 1)]};
+        i.pc = pc;
+        i.bank = bank;
+        i.sp = sp;
+        i.af = af;
+        i.opcode = opcode;
+        ++count_;
+    }
+
+    // Called for a write to FF00-FFFF by the instruction last record()ed.
+    void record_io(uint16_t pc, uint16_t adr, uint8_t value)
+    {
+        io_writes_[io_count_++ & (IO_WRITES - 1)] = {count_ - 1, pc,
+                                                     static_cast<uint8_t>(adr), value};
+    }
+
+    void clear();
+
+    // Instructions recorded since the last clear(), including those no longer held.
+    uint64_t count() const { return count_; }
+
+    // The instructions and IO writes held, oldest first. The number of instructions[i] is
+    // count() - instructions().size() + i.
+    std::vector<Instruction> instructions() const;
+    std::vector<Io_write> io_writes() const;
+
+    // Call f(const Instruction &) on the last n instructions held, or all of them if fewer are
+    // held, oldest first. Unlike instructions() it doesn't copy the ring.
+    template <typename F>
+    void for_each_last(uint64_t n, F f) const
+    {
+        n = std::min<uint64_t>({n, count_, instructions_.size()});
+        for (uint64_t i {count_ - n}; i < count_; ++i)
+            f(instructions_[i & (INSTRUCTIONS - 1)]);
+    }
+
+    // Write the rings as text, one line per instruction, with the IO writes each
+    // instruction made listed below it.
+    void dump(std::ostream &os) const;
+
+    private:
+    std::vector<Instruction> instructions_;
+    std::vector<Io_write> io_writes_;
+    uint64_t count_ {0};
+    uint64_t io_count_ {0};
+};
+
+}
+
+#endif // FLIGHT_RECORDER_HPP
@@ -24,6 +24,8 @@ class Joypad
     uint8_t read_reg();
     void write_reg(uint8_t b);
     void reset();
+    // Copy the button state and selection of another joypad.
+    void copy_state(const Joypad &other);
 
     private:
     void update_button(Input, bool pressed);
@@ -0,0 +1,90 @@
+#ifndef LINK_CABLE_HPP
+#define LINK_CABLE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace qtboy
+{
+
+class Gameboy;
+
+// Connects the serial ports of two Gameboys in the same process and runs each on its own
+// thread. The two emulated clocks are kept in lockstep: neither instance runs more than
+// max_skew cycles ahead of the other (one serial bit time, 512 cycles, by default), plus
+// the length of the instruction it was executing (an OAM DMA counts as 640 cycles). The
+// instances only synchronize every max_skew / 2 cycles and when a byte is exchanged, so
+// both run at full speed in between without any per-instruction locking.
+//
+// The instance that starts a transfer with its internal clock exchanges its byte with
+// whatever the other instance has in SB, provided that one is waiting on an external
+// clock. Otherwise the sender reads 0xff, as if nothing was connected.
+class Link_cable
+{
+    public:
+    static constexpr uint64_t DEFAULT_MAX_SKEW {512};
+
+    // Connect a and b. Both must have a ROM loaded and must not be running on their own
+    // threads (run_concurrently()) or in an Executor while connected.
+    Link_cable(Gameboy &a, Gameboy &b, uint64_t max_skew = DEFAULT_MAX_SKEW);
+    Link_cable(const Link_cable &) = delete;
+    Link_cable &operator=(const Link_cable &) = delete;
+    // Stops both instances and disconnects their serial ports.
+    ~Link_cable();
+
+    // Run both instances for the given number of cycles each. Blocks until both are done.
+    void run_for(uint64_t cycles);
+
+    // Run both instances in the background until stop() is called.
+    void start();
+    void stop();
+
+    // Bytes exchanged over the cable.
+    uint64_t transfers() const { return transfers_; }
+
+    // Largest difference between the two clocks seen at a synchronization point.
+    uint64_t max_observed_skew() const { return max_observed_skew_; }
+
+    private:
+    // One end of the cable.
+    struct End
+    {
+        Gameboy *system {nullptr};
+        uint64_t base {0}; // elapsed cycles when the run started
+        uint64_t target {0}; // cycles to run (relative to base)
+        std::atomic<uint64_t> time {0}; // cycles run (relative to base)
+        std::atomic<bool> done {true};
+        std::thread thread {};
+        // a byte clocked in by the other end: Idle -> Request -> Reply -> Idle
+        std::atomic<int> mailbox {0};
+        uint8_t in {0xff}, out {0xff};
+    };
+
+    enum Mailbox { Idle = 0, Request, Reply };
+
+    void launch(uint64_t cycles);
+    void join();
+
+    // Emulation thread of end i.
+    void run(std::size_t i);
+
+    // Answer a byte clocked in by the other end, if there is one. Only called on end i's
+    // emulation thread.
+    void service(std::size_t i);
+
+    // Transfer callback of end i: clock byte b into the other end and return its reply.
+    uint8_t transfer(std::size_t i, uint8_t b);
+
+    private:
+    std::array<End, 2> ends_ {};
+    uint64_t max_skew_;
+    std::atomic<bool> stopping_ {false};
+    std::atomic<uint64_t> transfers_ {0};
+    std::atomic<uint64_t> max_observed_skew_ {0};
+};
+
+}
+
+#endif // LINK_CABLE_HPP
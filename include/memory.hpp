@@ -17,6 +17,7 @@ class Ppu;
 class Joypad;
 class Apu;
 class Processor;
+class Serial;
 
 
 class Memory
@@ -29,7 +30,7 @@ class Memory
     struct Dump;
 
     // References to other components are needed to access their internal registers.
-    explicit Memory(Processor &c, Ppu &p, Timer &t, Joypad &j, Apu &a);
+    explicit Memory(Processor &c, Ppu &p, Timer &t, Joypad &j, Apu &a, Serial &s);
 
     // Read a byte from a specified address.
     uint8_t read(uint16_t adr) const;
@@ -49,6 +50,9 @@ class Memory
     // Create and load a cartridge from a specified input stream pointing to a valid ROM file.
     Cartridge *load_cartridge(std::istream &is);
 
+    // Create and load a cartridge from an already loaded ROM image.
+    Cartridge *load_cartridge(Rom rom);
+
     // Enable/disable CGB mode. This is done automatically when loading a CGB cartridge
     // but can also be disabled manually to force DMG mode.
     void enable_cgb(bool is_cgb);
@@ -62,12 +66,31 @@ class Memory
     // Copy a memory dump into memory.
     void load_memory(const Dump &dump);
 
+    // Copy everything in another memory, including the cartridge RAM and banking state and
+    // any HDMA in progress. The cartridge shares other's ROM image. The debug callback and
+    // memory log are kept.
+    void copy_state(const Memory &other);
+
     // Dump the currently mapped regions of memory.
     std::unordered_map<std::string, Memory_range> dump_mapped() const;
 
+    // Copy the n bytes from first on (first + n <= 0x10000) that dump_mapped() shows, without
+    // dumping the rest.
+    void dump_mapped(uint16_t first, std::size_t n, uint8_t *out) const;
+
+    // The name dump_mapped() gives the region holding adr, such as "ROM3" or "WRM1".
+    std::string mapped_name(uint16_t adr) const;
+
     // Dump the entire ROM (even banks not mapped in memory).
     std::vector<uint8_t> dump_rom() const;
 
+    // The bank currently mapped at adr: the ROM bank for ROMX, the VRAM, cartridge RAM or
+    // WRAM bank for those regions, 0 for everything else.
+    uint16_t bank(uint16_t adr) const;
+
+    // The loaded cartridge, nullptr if there is none.
+    const Cartridge *cartridge() const { return cart_.get(); }
+
     // Dump the RAM on cartridge (for generating save files).
     std::vector<uint8_t> dump_sram() const;
 
@@ -111,6 +134,7 @@ class Memory
     Timer &timer_; // to access hardware registers
     Joypad &joypad_; // to access hardware registers
     Apu &apu_; // access hardware registers
+    Serial &serial_; // to access hardware registers
     uint8_t ie_ {};
     bool cgb_mode_ {false};
     bool hdma_active_ {false};
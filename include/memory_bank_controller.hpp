@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <optional>
 
 #include "rom.hpp"
 #include "ram.hpp"
@@ -16,11 +18,15 @@ class Memory_bank_controller
 	virtual uint8_t read(uint16_t adr) const = 0;
 	virtual void write(uint8_t b, uint16_t adr) = 0; 
     virtual const char *type() const = 0;
-    virtual uint8_t rom_bank() const { return 0; }
+    virtual uint16_t rom_bank() const { return 0; }
     virtual uint8_t ram_bank() const { return 0; }
     // for MBCs with built-in RAM (MBC2)
     virtual std::vector<uint8_t> dump_ram() const { return {}; }
     virtual void load_sram(const std::vector<uint8_t> &) { return; }
+    // Copy this controller's banking state into a new controller reading from rom and ram
+    // (the ROM and RAM of the cartridge that will own the copy).
+    virtual std::unique_ptr<Memory_bank_controller> clone(Rom *rom,
+                                                          std::optional<External_ram> *ram) const = 0;
     virtual ~Memory_bank_controller() = default;
 };
 
@@ -28,7 +34,6 @@ class Mbc1 : public Memory_bank_controller
 {
 	public:
     explicit Mbc1(Rom *rom, std::optional<External_ram> *ram);
-    Mbc1(const Mbc1 &) = delete;
     Mbc1 &operator=(const Mbc1 &) = delete;
     ~Mbc1() override = default;
 
@@ -37,13 +42,18 @@ class Mbc1 : public Memory_bank_controller
     void load_sram(const std::vector<uint8_t> &sram) override;
     std::vector<uint8_t> dump_ram() const override;
     const char *type() const override { return "MBC1"; }
-    uint8_t rom_bank() const override { return rom_bank_; }
+    std::unique_ptr<Memory_bank_controller> clone(Rom *rom,
+                                                  std::optional<External_ram> *ram) const override;
+    uint16_t rom_bank() const override { return rom_bank_; }
     uint8_t ram_bank() const override { return ram_bank_; }
 
     private:
     void adjust_rom_bank();
 
 	private:
+    // only copied by clone(), which points the copy at its own ROM and RAM
+    Mbc1(const Mbc1 &) = default;
+
     Rom *rom_;
     std::optional<External_ram> *ram_;
 	uint8_t ram_bank_ {0};
@@ -58,7 +68,6 @@ class Mbc2 : public Memory_bank_controller
 {
     public:
     explicit Mbc2(Rom *rom);
-    Mbc2(const Mbc2 &) = delete;
     Mbc2 &operator=(const Mbc2 &) = delete;
     ~Mbc2() override = default;
 
@@ -67,9 +76,14 @@ class Mbc2 : public Memory_bank_controller
     void load_sram(const std::vector<uint8_t> &sram) override;
     std::vector<uint8_t> dump_ram() const override;
     const char *type() const override { return "MBC2"; }
-    uint8_t rom_bank() const override { return rom_bank_; }
+    std::unique_ptr<Memory_bank_controller> clone(Rom *rom,
+                                                  std::optional<External_ram> *ram) const override;
+    uint16_t rom_bank() const override { return rom_bank_; }
 
     private:
+    // only copied by clone(), which points the copy at its own ROM and RAM
+    Mbc2(const Mbc2 &) = default;
+
     Rom *rom_;
     uint8_t rom_bank_ {1};
     std::vector<uint8_t> ram_;
@@ -81,7 +95,6 @@ class Mbc3 : public Memory_bank_controller
 {
     public:
     explicit Mbc3(Rom *rom, std::optional<External_ram> *ram);
-    Mbc3(const Mbc3 &) = delete;
     Mbc3 &operator=(const Mbc3 &) = delete;
     ~Mbc3() override = default;
 
@@ -90,7 +103,9 @@ class Mbc3 : public Memory_bank_controller
     void load_sram(const std::vector<uint8_t> &sram) override;
     std::vector<uint8_t> dump_ram() const override;
     const char *type() const override { return "MBC3"; }
-    uint8_t rom_bank() const override { return rom_bank_; }
+    std::unique_ptr<Memory_bank_controller> clone(Rom *rom,
+                                                  std::optional<External_ram> *ram) const override;
+    uint16_t rom_bank() const override { return rom_bank_; }
     uint8_t ram_bank() const override { return ram_bank_; }
 
     void load_rtc(const std::array<uint8_t, 5> &base);
@@ -99,6 +114,9 @@ class Mbc3 : public Memory_bank_controller
     void update_rtc() const;
 
 	private:
+    // only copied by clone(), which points the copy at its own ROM and RAM
+    Mbc3(const Mbc3 &) = default;
+
     Rom *rom_;
     std::optional<External_ram> *ram_;
     bool ram_rtc_enable_ {false};
@@ -119,7 +137,6 @@ class Mbc5 : public Memory_bank_controller
 {
 	public:
     explicit Mbc5(Rom *rom, std::optional<External_ram> *ram);
-    Mbc5(const Mbc5 &) = delete;
     Mbc5 &operator=(const Mbc5 &) = delete;
     ~Mbc5() override = default;
 
@@ -128,10 +145,15 @@ class Mbc5 : public Memory_bank_controller
     void load_sram(const std::vector<uint8_t> &sram) override;
     std::vector<uint8_t> dump_ram() const override;
     const char *type() const override { return "MBC5"; }
-    uint8_t rom_bank() const override { return rom_bank_; }
+    std::unique_ptr<Memory_bank_controller> clone(Rom *rom,
+                                                  std::optional<External_ram> *ram) const override;
+    uint16_t rom_bank() const override { return rom_bank_; }
     uint8_t ram_bank() const override { return ram_bank_; }
 	
 	private:
+    // only copied by clone(), which points the copy at its own ROM and RAM
+    Mbc5(const Mbc5 &) = default;
+
     Rom *rom_;
     std::optional<External_ram> *ram_;
 	bool ram_enable_ {false};
@@ -0,0 +1,64 @@
+#ifndef MOVIE_HPP
+#define MOVIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "joypad.hpp"
+
+namespace qtboy
+{
+
+// A recording of joypad input stamped with the emulated cycle it took effect on, plus
+// periodic hashes of the emulator state. Movies always start at power on, so playing one
+// back on the same ROM reproduces the recorded run exactly, and a mismatching state hash
+// pinpoints where two builds diverge.
+class Movie
+{
+    public:
+    struct Input_event
+    {
+        uint64_t cycle;
+        Joypad::Input input;
+        bool pressed;
+    };
+
+    struct Checkpoint
+    {
+        uint64_t cycle;
+        uint64_t hash;
+    };
+
+    // One checkpoint per second of emulated time by default.
+    static constexpr uint64_t DEFAULT_CHECKPOINT_INTERVAL {70224 * 60};
+
+    explicit Movie(uint64_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL);
+
+    void add_input(uint64_t cycle, Joypad::Input i, bool pressed);
+    void add_checkpoint(uint64_t cycle, uint64_t hash);
+
+    const std::vector<Input_event> &inputs() const { return inputs_; }
+    const std::vector<Checkpoint> &checkpoints() const { return checkpoints_; }
+    uint64_t checkpoint_interval() const { return checkpoint_interval_; }
+
+    // Title of the ROM the movie was recorded on.
+    const std::string &title() const { return title_; }
+    void set_title(const std::string &title) { title_ = title; }
+
+    // Write the movie to a text file at path. Returns false if the file can't be written.
+    bool save(const std::string &path) const;
+
+    // Read a movie written by save(). Throws std::runtime_error on a malformed file.
+    static Movie load(const std::string &path);
+
+    private:
+    uint64_t checkpoint_interval_;
+    std::string title_ {};
+    std::vector<Input_event> inputs_ {};
+    std::vector<Checkpoint> checkpoints_ {};
+};
+
+}
+
+#endif // MOVIE_HPP
@@ -2,6 +2,7 @@
 #define NOISE_CHANNEL_HPP
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 
 namespace qtboy
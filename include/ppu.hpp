@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "graphic_types.hpp"
+#include "profiler.hpp"
 
 namespace qtboy
 {
@@ -35,10 +36,18 @@ class Ppu
     enum class Layer { Background, Window, Sprite};
     enum class Color_correction { None, Fast, Proper };
 
+    // What the scanline renderer produces. Rgb draws RGB555 textures through the renderer.
+    // Palette_index (the 2-bit shade, after the DMG palette registers are applied) and
+    // Luminance (8-bit gray) skip color resolution and the renderer entirely, and fill an
+    // 8-bit frame read with output_frame() instead.
+    enum class Output { Rgb, Palette_index, Luminance };
+
     Ppu(Memory &m,
         Processor &p,
         Renderer *r = nullptr);
     void reset();
+    // Copy the registers, mode clock and sprite state of another PPU. The renderer is kept.
+    void copy_state(const Ppu &other);
     void enable_cgb(bool is_cgb);
     void step(size_t cycles);
     int mode() const;
@@ -47,6 +56,25 @@ class Ppu
     uint8_t read_reg(uint16_t adr);
     void write_reg(uint8_t b, uint16_t adr);
     void set_renderer(Renderer *r);
+    Renderer *renderer() const { return renderer_; }
+
+    // Attribute time spent scanning OAM, rendering and presenting to p, and end p's frames
+    // at VBLANK. nullptr (the default) turns profiling off.
+    void set_profiler(Profiler *p);
+
+    // Select the output format. Palette_index and Luminance frames are area downsampled to
+    // width x height (at most 160x144): each output pixel is the average of the block of
+    // screen pixels that falls on it.
+    void set_output(Output o, unsigned width = 160, unsigned height = 144);
+    Output output() const;
+
+    // Last complete Palette_index or Luminance frame, width * height bytes row major.
+    // Published at VBLANK, so it never holds a partly drawn frame.
+    const std::vector<uint8_t> &output_frame() const;
+
+    // While held, VBLANK drops the Palette_index or Luminance frame drawn instead of
+    // publishing it, so output_frame() keeps the last one published.
+    void hold_output(bool b) { output_held_ = b; }
 
     // debug
     Palette get_bg_palette(uint8_t idx) const;
@@ -67,12 +95,21 @@ class Ppu
     uint8_t read_vram(uint8_t bank, uint16_t adr) const;
     void write_vram(uint8_t b, uint8_t bank, uint16_t adr);
     void render_scanline();
+    // Resolve the palettes used by the current scanline (colors, shades or luminance
+    // depending on output_) so pixels only have to index them.
+    void update_line_palettes();
     void render_layer_line(Texture &tex, Layer l);
     // (x,y): coordinate in VRAM tilemap to get pixel from
     // (tex_x, tex_y): pixel to draw in Texture
+    // pals: the 8 background palettes to color the pixel with
     void render_layer_pixel(Texture &tex, Layer l, uint8_t x, uint8_t y,
-                            uint8_t tex_x, uint8_t tex_y) const;
+                            uint8_t tex_x, uint8_t tex_y,
+                            const std::array<Palette, 8> &pals) const;
     void render_sprite_line(Texture &tex);
+    // Add the current scanline to the downsampled output frame.
+    void output_scanline();
+    // Publish the finished output frame at VBLANK.
+    void output_frame_done();
     void order_sprites(std::array<Sprite, 10> &s) const;
     void load_sprites();
     void oam_scan(); // mode 2
@@ -89,6 +126,7 @@ class Ppu
     Memory &memory_;
     Processor &cpu_;
     Renderer *renderer_;
+    Profiler *profiler_ {nullptr};
     int clock_ {0};
     uint8_t window_line_ {0}; // keep track of how many window lines were drawn
     uint8_t lcdc_ {0x90}, stat_ {0x00}; // ff40, ff41
@@ -102,11 +140,24 @@ class Ppu
 
     // CGB registers
     bool cgb_mode_ {false};
+    bool output_held_ {false};
     std::array<uint8_t, 0x40> bgpd_ {}; // background palette data
     std::array<uint8_t, 0x40> obpd_ {}; // object palette data
     uint8_t bgpi_ {0}; // ff68
     uint8_t obpi_ {0}; // ff6a
 
+    // scanline being rendered, reused so rendering doesn't allocate
+    Texture line_ {160, 1};
+    std::array<Palette, 8> line_bg_pals_ {}, line_sprite_pals_ {};
+
+    // 8-bit output (see set_output())
+    Output output_ {Output::Rgb};
+    unsigned out_w_ {160}, out_h_ {144};
+    std::array<uint16_t, 160> out_col_ {}; // output column of each screen column
+    std::array<uint16_t, 144> out_row_ {}; // output row of each screen row
+    std::vector<uint32_t> out_acc_ {}; // sum of the screen pixels in each output pixel
+    std::vector<uint16_t> out_area_ {}; // number of screen pixels in each output pixel
+    std::vector<uint8_t> out_frame_ {};
 
 
 };
@@ -8,6 +8,10 @@
 #include "register_pair.hpp"
 #include "memory.hpp"
 #include "disassembler.hpp"
+#include "execution_histogram.hpp"
+#include "call_profiler.hpp"
+#include "flight_recorder.hpp"
+#include "coverage.hpp"
 
 
 namespace qtboy
@@ -30,6 +34,8 @@ class Processor
               std::function<void(uint8_t, uint16_t)> wr);
     void step();
     void reset(bool force_dmg = false);
+    // Copy the registers and internal state of another processor. The memory callbacks are kept.
+    void copy_state(const Processor &other);
     Cpu_dump dump() const noexcept;
     void request_interrupt(Interrupt i);
     void toggle_double_speed();
@@ -41,15 +47,40 @@ class Processor
     uint16_t sp() const noexcept { return sp_; }
     uint16_t pc() const noexcept { return pc_; }
     uint32_t cycles() const noexcept { return cycles_; }
+    bool ime() const noexcept { return ime_; }
     // Manually add cycles to cycle count. This is useful for OAM DMA transfers: they need to take
     // 160 machine cycles (640 clock cycles).
     void add_cycles(uint32_t c);
     bool stopped() const noexcept { return stpd_; }
     bool halted() const noexcept { return hltd_; }
     bool double_speed() const noexcept { return double_speed_; }
+    // True while the read callback is fetching an opcode or operand rather than data.
+    bool fetching() const noexcept { return fetching_; }
 
     std::vector<uint8_t> next_ops(uint16_t n) const;
 
+    // Count every instruction executed in h from now on. nullptr stops counting. Counting is
+    // always compiled in: without a histogram the counts go to scratch counters, so step()
+    // never branches on it.
+    void set_histogram(Execution_histogram *h);
+    // True if counting into a histogram.
+    bool counting() const noexcept { return counters_.ops != scratch_.data(); }
+
+    // Report calls, returns and interrupts to p from now on. nullptr stops reporting.
+    void set_call_profiler(Call_profiler *p);
+    Call_profiler *call_profiler() const noexcept { return call_profiler_; }
+
+    // Record every instruction executed in r from now on. nullptr stops recording.
+    void set_flight_recorder(Flight_recorder *r) noexcept { flight_recorder_ = r; }
+
+    // Mark the bytes fetched as instructions and read as data in c from now on. nullptr
+    // stops marking.
+    void set_coverage(Coverage *c) noexcept { coverage_ = c; }
+
+    // Tell the processor which ROM bank is mapped at 4000-7fff, for the histogram, the
+    // call profiler and the coverage.
+    void set_rom_bank(uint16_t bank) noexcept { rom_bank_ = bank; }
+
     private:
 
     enum Flags : uint8_t
@@ -70,12 +101,42 @@ class Processor
         // called, since they don't take effect until the next instruction
     bool halt_bug_ {false};
     bool double_speed_ {false}; // CGB only
+    uint16_t rom_bank_ {1};
+    bool fetching_ {false};
+
+    // Where step() counts executions: a histogram's arrays, or scratch_ with masks that send
+    // every bank:PC to a single counter.
+    struct Counters
+    {
+        uint64_t *ops;
+        uint64_t *cb_ops;
+        uint64_t *pcs;
+        uint32_t pc_mask;
+        uint16_t bank_mask;
+    };
+    Counters scratch_counters() noexcept;
+    std::array<uint64_t, 257> scratch_ {};
+    Counters counters_ {scratch_counters()};
+
+    Call_profiler *call_profiler_ {nullptr};
+    Flight_recorder *flight_recorder_ {nullptr};
+    Coverage *coverage_ {nullptr};
+    // Report a call or interrupt to adr, after the return address was pushed.
+    void profile_call(uint16_t adr);
 
     std::function<uint8_t(uint16_t)> read;
     std::function<void(uint8_t, uint16_t)> write;
     uint8_t fetch8();
     uint16_t fetch16();
 
+    // Read memory an instruction operates on (anything but the instruction itself).
+    uint8_t read_data(uint16_t adr)
+    {
+        if (coverage_)
+            coverage_->mark_data(rom_bank_, adr);
+        return read(adr);
+    }
+
     // flags
     bool get_flag(Flags f) const;
     void set_flag(Flags, bool);
@@ -0,0 +1,167 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace qtboy
+{
+
+// Attributes host time and call counts to the emulator's components, frame by frame.
+// Components are entered and left like a call stack and every tick is charged to the
+// component on top, so time is exclusive: memory bus accesses made by an instruction count
+// as Memory, not Cpu. Timestamps come from the TSC where there is one (steady_clock
+// otherwise) and are converted to nanoseconds when results are read.
+//
+// enter(), leave() and switch_to() are only called from the emulation thread. Results can
+// be read from any thread.
+class Profiler
+{
+    public:
+    enum class Component
+    {
+        Other, // emulation loop overhead: input, movies, serial port
+        Cpu,
+        Memory,
+        Ppu, // mode bookkeeping, STAT interrupts, HBLANK DMA
+        Ppu_oam_scan,
+        Ppu_render, // drawing scanlines
+        Ppu_present, // downsampling 8-bit output frames (Ppu::set_output())
+        Apu,
+        Timer,
+        Renderer, // the frontend's Renderer, drawing lines and presenting frames
+        Count
+    };
+    static constexpr std::size_t COMPONENTS {static_cast<std::size_t>(Component::Count)};
+
+    // Lowercase names of the components, as used in the CSV header.
+    static const std::array<const char *, COMPONENTS> component_names;
+
+    struct Frame
+    {
+        std::array<double, COMPONENTS> ns {};
+        std::array<uint64_t, COMPONENTS> calls {};
+        // sum of ns
+        double total_ns {0};
+    };
+
+    // Keep the breakdown of the last history frames.
+    explicit Profiler(std::size_t history = 3600);
+
+    // Start charging time to Component::Other. Calls nest, only the outermost counts.
+    void resume()
+    {
+        if (depth_++ == 0)
+        {
+            stack_[0] = Component::Other;
+            top_ = 0;
+            last_ = now();
+        }
+    }
+
+    // Stop charging time, e.g. while the emulator throttles or waits between frames.
+    void pause()
+    {
+        if (--depth_ == 0)
+            charge(now());
+    }
+
+    // Charge the time since the last event to the current component and make c current
+    // until the matching leave().
+    void enter(Component c)
+    {
+        charge(now());
+        stack_[++top_] = c;
+        ++current_.calls[static_cast<std::size_t>(c)];
+    }
+
+    void leave()
+    {
+        charge(now());
+        --top_;
+    }
+
+    // leave() followed by enter(c), with a single timestamp.
+    void switch_to(Component c)
+    {
+        charge(now());
+        stack_[top_] = c;
+        ++current_.calls[static_cast<std::size_t>(c)];
+    }
+
+    // Close the current frame (called by the PPU when it enters VBLANK).
+    void end_frame();
+
+    // Forget every frame recorded so far. Not while the emulation thread is profiling.
+    void clear();
+
+    // Breakdown of the last frames recorded, oldest first.
+    std::vector<Frame> frames() const;
+
+    // Sum of every frame recorded since the last clear(), including those no longer in
+    // frames().
+    Frame totals() const;
+    uint64_t frame_count() const;
+
+    // Write frames() as CSV: one line per frame with its number, total and the time (ns) and
+    // calls of every component.
+    void write_csv(std::ostream &os) const;
+
+    private:
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    void charge(uint64_t t)
+    {
+        current_.ticks[static_cast<std::size_t>(stack_[top_])] += t - last_;
+        last_ = t;
+    }
+
+    // Nanoseconds per tick, measured against steady_clock since construction.
+    double ns_per_tick() const;
+
+    Frame to_frame(const std::array<uint64_t, COMPONENTS> &ticks,
+                   const std::array<uint64_t, COMPONENTS> &calls,
+                   double scale) const;
+
+    struct Raw_frame
+    {
+        std::array<uint64_t, COMPONENTS> ticks {};
+        std::array<uint64_t, COMPONENTS> calls {};
+    };
+
+    // emulation thread state
+    std::array<Component, 16> stack_ {};
+    std::size_t top_ {0};
+    unsigned depth_ {0};
+    uint64_t last_ {0};
+    Raw_frame current_ {};
+
+    // closed frames, a ring of history entries
+    mutable std::mutex mutex_;
+    std::vector<Raw_frame> history_;
+    std::size_t next_ {0};
+    uint64_t frame_count_ {0};
+    Raw_frame totals_ {};
+    uint64_t start_ticks_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+}
+
+#endif // PROFILER_HPP
@@ -3,6 +3,8 @@
 #include <array>
 #include <vector>
 #include <iostream>
+#include <string>
+#include <memory>
 
 #include "debug_types.hpp"
 
@@ -16,13 +18,50 @@ class Rom
 	using Bank = std::array<uint8_t, Bank_size>; // 16 KB
     explicit Rom() = default;
 	explicit Rom(std::istream &is);
-	
-	uint8_t read(uint8_t bank, uint16_t adr) const;
-    std::vector<uint8_t> dump(uint8_t bank) const;
+
+    // Map the ROM file at path directly into memory. Bank reads go straight to the mapping,
+    // so nothing is copied at startup and the page cache is shared with other processes
+    // running the same ROM. Falls back to reading the file through a stream if the file
+    // can't be mapped.
+    explicit Rom(const std::string &path);
+
+    // Copies are cheap: the ROM image is immutable and reference counted, so every copy
+    // (and every Cartridge made from one) reads from the same image.
+    Rom(const Rom &) = default;
+    Rom(Rom &&) = default;
+    Rom &operator=(const Rom &) = default;
+    Rom &operator=(Rom &&) = default;
+    ~Rom() = default;
+
+	uint8_t read(uint16_t bank, uint16_t adr) const;
+
+    // Pointer to the first byte of a bank. The last bank may be shorter than Bank_size if the
+    // ROM file isn't a multiple of 16 KB, check size() before reading past its end.
+    const uint8_t *bank_data(uint16_t bank) const;
+
+    // Number of 16 KB banks (a trailing partial bank counts as a bank).
+    size_t banks() const;
+
+    // Size of the ROM image in bytes.
+    size_t size() const;
+
+    // True if the ROM is backed by a memory mapped file rather than a heap copy.
+    bool is_mapped() const;
+
+    // Number of Rom handles currently sharing this image.
+    long use_count() const;
+
+    std::vector<uint8_t> dump(uint16_t bank) const;
     std::vector<uint8_t> dump() const;
-	
+
 	private:
-	std::vector<Bank> data_;
+    // Owns the bytes of a ROM, either a file mapping or a heap buffer.
+    class Image;
+
+    std::shared_ptr<const Image> image_ {nullptr};
+    // cached from image_ so reads don't have to go through the shared pointer
+    const uint8_t *data_ {nullptr};
+    size_t size_ {0};
 };
 	
 }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace qtboy
+{
+
+class Processor;
+
+// Serial port (SB ff01, SC ff02). A transfer started with the internal clock shifts one byte
+// out and one byte in at 8192 Hz (256 KHz with the CGB fast clock), then requests the Serial
+// interrupt. The byte shifted in comes from the transfer callback, or is 0xff (nothing
+// connected) if there isn't one. Transfers waiting on an external clock never finish unless
+// a peer drives the clock with external_transfer().
+class Serial
+{
+    public:
+    // Called when an internally clocked transfer finishes with the byte sent. Returns the
+    // byte received.
+    using Transfer_callback = std::function<uint8_t(uint8_t)>;
+
+    explicit Serial(Processor &p);
+
+    void update(std::size_t cycles);
+    uint8_t read(uint16_t adr) const;
+    void write(uint8_t b, uint16_t adr);
+    void reset();
+    void enable_cgb(bool is_cgb);
+
+    // Copy the registers and transfer progress of another serial port (not its callback).
+    void copy_state(const Serial &other);
+
+    void set_transfer_callback(Transfer_callback cb);
+
+    // Complete a transfer clocked by the other end of the link: shift in b and return the
+    // byte shifted out. Does nothing and returns 0xff unless a transfer is waiting for an
+    // external clock (SC bit 7 set, bit 0 cleared).
+    uint8_t external_transfer(uint8_t b);
+
+    // True while a transfer is started (SC bit 7).
+    bool transferring() const { return sc_ & 0x80; }
+
+    // True if the current transfer uses the internal clock (SC bit 0).
+    bool internal_clock() const { return sc_ & 1; }
+
+    private:
+    // Finish the current transfer: latch the received byte and request the interrupt.
+    void complete(uint8_t received);
+
+    private:
+    Processor &cpu_;
+    Transfer_callback transfer_callback_ {};
+    uint8_t sb_ {0}; // ff01
+    uint8_t sc_ {0}; // ff02
+    int cycles_left_ {0}; // until an internally clocked transfer finishes
+    bool cgb_mode_ {false};
+    static constexpr int CYCLES_PER_BIT {512}; // 4194304 Hz / 8192 Hz
+    static constexpr int FAST_CYCLES_PER_BIT {16}; // CGB fast clock, 262144 Hz
+};
+
+}
@@ -2,6 +2,7 @@
 #define CHANNEL_HPP
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 
 namespace qtboy
@@ -7,6 +7,8 @@
 #include <condition_variable>
 #include <atomic>
 #include <memory>
+#include <optional>
+#include <deque>
 
 #include "processor.hpp"
 #include "memory.hpp"
@@ -17,7 +19,14 @@
 #include "joypad.hpp"
 #include "apu.hpp"
 #include "speaker.hpp"
+#include "serial.hpp"
 #include "debugger.hpp"
+#include "movie.hpp"
+#include "breakpoints.hpp"
+#include "watchpoints.hpp"
+#include "cpu_trace.hpp"
+#include "flight_recorder.hpp"
+#include "profiler.hpp"
 
 namespace qtboy
 {
@@ -37,34 +46,51 @@ class Gameboy
     // Load the ROM file at path into memory.
     bool load_cartridge(const std::string &path);
 
-    // Set the renderer to use to display video output. This must be set for video output.
+    // Load an already opened ROM image. The image is shared, not copied, so any number of
+    // Gameboys can run the same cartridge from one copy of the ROM. title names the .sav file.
+    bool load_cartridge(const Rom &rom, const std::string &title);
+
+    // Set the renderer to use to display video output. This must be set for video output,
+    // without one the emulator runs headless.
     void set_renderer(Renderer *r);
 
-    // Set the speaker to use to play audio output. This must be set for audio output.
+    // Set the speaker to use to play audio output. This must be set for audio output,
+    // without one no audio samples are generated.
     void set_speaker(std::shared_ptr<Speaker> s);
 
+    // Make the PPU produce 8-bit palette index or luminance frames of width x height instead
+    // of drawing through the renderer (see Ppu::set_output()). Ppu::Output::Rgb restores
+    // normal rendering.
+    void set_output(Ppu::Output o, unsigned width = 160, unsigned height = 144);
+
+    // Last complete frame produced by set_output(). Only read it while the emulator isn't
+    // running on another thread.
+    const std::vector<uint8_t> &output_frame() const;
+
     // Stop the emulator that is currently running from a call to run_concurrently().
     void stop();
 
     // Pause the emulator. The emulation thread is kept alive and can be resumed with resume().
     void pause();
 
-    // Resumes the emulator paused with pause().
+    // Resumes the emulator paused with pause() or stopped at a breakpoint.
     void resume();
 
     // Stops the emulator, unloads the ROM, and resets the memory, CPU, PPU, APU, timer, and joypad.
     void reset();
 
-    // Step through n CPU instructions.
+    // Step through n CPU instructions. If emulation throws, the flight recorder is written to
+    // the crash dump path (see set_crash_dump_path()) before the exception propagates.
     size_t step(size_t n);
 
     // Run the CPU for cyc cycles.
     size_t execute(size_t cyc);
 
-    // Press a specified input on the joypad.
+    // Press a specified input on the joypad. Input is queued and takes effect on the emulation
+    // thread at the next instruction, so it can be stamped with an exact cycle.
     void press(Joypad::Input i);
 
-    // Release a specified input on the joypad.
+    // Release a specified input on the joypad. Queued like press().
     void release(Joypad::Input i);
 
     // Enables or disables CPU throttling (unlimited FPS)
@@ -74,19 +100,134 @@ class Gameboy
 
     void set_force_dmg(bool b);
 
+    // Set a callback called on the emulation thread whenever the game finishes sending a byte
+    // over the serial port with its internal clock. The callback returns the byte received in
+    // exchange (0xff if nothing is connected). Useful for capturing test ROM output.
+    void set_serial_callback(Serial::Transfer_callback cb);
+
+    // Clock a byte in from a link partner driving the serial clock. Returns the byte shifted
+    // out, or 0xff if the game isn't waiting on an external clock. Must be called from the
+    // thread emulating this Gameboy (or while it isn't running).
+    uint8_t link_transfer(uint8_t b);
+
     // Get the total number of cycles ran by the CPU.
     size_t cycles() const;
 
+    // Get the total number of cycles emulated since the last reset. Unlike cycles(), this
+    // doesn't wrap around after ~17 minutes of emulated time.
+    uint64_t elapsed_cycles() const;
+
     // Returns true if the emulator is running in CGB mode.
     bool is_cgb() const;
 
     // Returns true if the emulator is not paused nor stopped.
     bool is_running() const;
 
-    // memory read/write functions passed as callbacks to CPU
+    //
+    // Movie methods
+    //
+
+    // Start recording input into a movie. Recording from power on (right after
+    // load_cartridge()) makes the movie replayable from a fresh start.
+    void record_movie(uint64_t checkpoint_interval = Movie::DEFAULT_CHECKPOINT_INTERVAL);
+
+    // Play back a movie from the current state (normally power on). Input from press() and
+    // release() is ignored until every recorded input has been replayed.
+    void play_movie(Movie m);
+
+    // Stop recording or playing back and return the movie.
+    Movie stop_movie();
+
+    // Returns true while a movie is being played back.
+    bool movie_playing() const;
+
+    // Returns true if a state hash didn't match the movie during playback.
+    bool movie_desynced() const;
+
+    //
+    // Snapshot methods
+    //
+
+    // Create a new Gameboy in exactly the same emulation state as this one, sharing its ROM
+    // image. The clone has no renderer, speaker or debug callbacks, isn't running, isn't
+    // recording or playing a movie, and never writes a .sav file. Safe to call while this
+    // Gameboy is running concurrently.
+    std::unique_ptr<Gameboy> clone() const;
+
+    // Put this Gameboy in the same emulation state as other (normally a clone() kept as a
+    // snapshot). Reuses this Gameboy's buffers, so restoring is much cheaper than cloning.
+    // The renderer, speaker, debug callbacks and .sav behaviour of this Gameboy are kept;
+    // queued input is dropped and movie recording or playback is stopped.
+    void restore(const Gameboy &other);
+
+    // Hash of the CPU registers, memory, PPU and timer registers, cartridge RAM and mapped
+    // banks. Two runs are in sync as long as their hashes at the same elapsed cycle match.
+    uint64_t state_hash() const;
+
+    // Read or write memory as the CPU sees it.
     uint8_t memory_read(uint16_t adr);
     void memory_write(uint8_t b, uint16_t adr);
 
+    //
+    // Reverse debugging methods
+    //
+
+    // Every interval cycles, keep a snapshot of the emulation state (the last snapshots of
+    // them) and log input, so that step_back() and reverse_continue() can go back in time by
+    // restoring a snapshot and re-executing from it. Disabling drops the history.
+    static constexpr uint64_t DEFAULT_HISTORY_INTERVAL {70224 * 10};
+    static constexpr size_t DEFAULT_HISTORY_SNAPSHOTS {30};
+    void set_history(bool b, uint64_t interval = DEFAULT_HISTORY_INTERVAL,
+                     size_t snapshots = DEFAULT_HISTORY_SNAPSHOTS);
+
+    // Go back to the start of the previous instruction. Returns false if the history doesn't
+    // reach back that far, or while a movie is recording or playing.
+    bool step_back();
+
+    // Go back to the last breakpoint or watchpoint hit before the current position and stop
+    // there as if emulation had run into it. If there is none, go back to the oldest
+    // snapshot and return false.
+    bool reverse_continue();
+
+    //
+    // Profiling methods
+    //
+
+    // Start attributing host time to the CPU, memory bus, PPU, APU, timer and renderer in a
+    // new, empty profiler, or stop (the profiler is kept). Only costs a branch per component
+    // when disabled. Don't toggle while running in an Executor or Link_cable.
+    void set_profiling(bool b);
+    bool profiling() const;
+
+    // Per-frame breakdown of the time spent while profiling last started, nullptr if it
+    // never was. Only read it while the emulator isn't running on another thread.
+    const Profiler *profiler() const;
+
+    // Start counting executions per opcode and bank:PC in a new, empty histogram, or stop
+    // counting (the counts are kept). A ROM must be loaded to start.
+    void set_execution_histogram(bool b);
+
+    // The last histogram started, nullptr if there never was one. Only read it while the
+    // emulator isn't running on another thread.
+    const Execution_histogram *execution_histogram() const;
+
+    // Start marking the bytes executed and read as data in a new, empty coverage map, or stop
+    // marking (the map is kept). A ROM must be loaded to start.
+    void set_coverage(bool b);
+
+    // The last coverage map started, nullptr if there never was one. Only use it while the
+    // emulator isn't running on another thread.
+    Coverage *coverage();
+    const Coverage *coverage() const;
+
+    // Start attributing emulated cycles to guest functions in a new, empty call profile, or
+    // stop (the profile is kept).
+    void set_call_profiling(bool b);
+
+    // The last call profile started, nullptr if there never was one. Only read it while the
+    // emulator isn't running on another thread.
+    const Call_profiler *call_profiler() const;
+
     //
     // Debugger methods
     //
@@ -94,6 +235,49 @@ class Gameboy
     // Enables or disables the calling of debug_callback_ after every CPU instruction.
     void set_debug_mode(bool b);
 
+    // Stop emulation (pause) before the instruction at adr is executed while bank is mapped
+    // there, or whatever bank is mapped with Breakpoints::ANY_BANK. See Memory::bank().
+    // With a condition such as "A == 0x3c && [0xd158] > 5" (see Condition), only stop when
+    // it holds. Adding a breakpoint again replaces its condition.
+    void add_breakpoint(uint16_t adr, int bank = Breakpoints::ANY_BANK,
+                        const std::string &condition = {});
+    void delete_breakpoint(uint16_t adr, int bank = Breakpoints::ANY_BANK);
+    std::vector<Breakpoints::Breakpoint> breakpoints() const;
+
+    // Enables or disables stopping at breakpoints (enabled by default).
+    void enable_breakpoints(bool b);
+
+    // Returns true while emulation is stopped at a breakpoint, until resume(). Stepping
+    // from a breakpoint executes its instruction.
+    bool at_breakpoint() const;
+
+    // Stop emulation after the instruction that reads, writes (access is a mask of
+    // Watchpoints::Access) or executes an address in [first, last] while bank is mapped
+    // there and condition holds. Only CPU accesses are watched, not DMA. Returns the
+    // watchpoint's id.
+    int add_watchpoint(uint16_t first, uint16_t last, uint8_t access,
+                       int bank = Watchpoints::ANY_BANK, const std::string &condition = {});
+    void delete_watchpoint(int id);
+    std::vector<Watchpoints::Watchpoint> watchpoints() const;
+
+    // The access that stopped emulation, until resume().
+    std::optional<Watchpoints::Hit> watchpoint_hit() const;
+
+    // Record the CPU state before every instruction executed to trace from now on. nullptr
+    // stops tracing.
+    void set_cpu_trace(std::shared_ptr<Cpu_trace> trace);
+    std::shared_ptr<Cpu_trace> cpu_trace() const;
+
+    // The CPU state before the next instruction, as a trace record.
+    Cpu_trace::Record trace_record() const;
+
+    // Write the last instructions executed and IO registers written (see Flight_recorder).
+    void dump_flight_recorder(std::ostream &os) const;
+
+    // Where the flight recorder is written when emulation throws. Empty, the default,
+    // disables the dump, so instances running side by side don't write over each other.
+    void set_crash_dump_path(const std::string &path);
+
     // Set a callback funciton that will be called after every CPU instruction in debug mode. The function
     // should take no arguments and return a boolean indicating if emulation should break.
     void set_cpu_debug_callback(std::function<bool()>);
@@ -106,12 +290,29 @@ class Gameboy
     // Dump the values currently mapped in memory.
     std::unordered_map<std::string, Memory_range> dump_mapped_memory() const;
 
+    // Copy n of the values currently mapped, from first on (first + n <= 0x10000), for
+    // views showing a window of memory.
+    void dump_mapped_memory(uint16_t first, std::size_t n, uint8_t *out) const;
+
+    // The name of the region mapped at adr in dump_mapped_memory(), such as "ROM3".
+    std::string mapped_region_name(uint16_t adr) const;
+
     // Dump the values in memory that have been changed since the last memory log dump.
     std::vector<Memory_byte> dump_memory_log();
 
     // Dump the currently loaded ROM.
     std::vector<uint8_t> dump_rom() const;
 
+    // The loaded ROM image (shared, not copied), nullptr if there is none.
+    const Rom *rom() const;
+
+    // The bank currently mapped at adr (see Memory::bank()).
+    uint16_t mapped_bank(uint16_t adr) const;
+
+    // The instructions recently executed. Only read it while the emulator isn't running on
+    // another thread.
+    const Flight_recorder &flight_recorder() const { return flight_recorder_; }
+
     // Dump the CPU registers, number of cycles, IME, and next 3 instructions.
     Cpu_dump dump_cpu() const;
 
@@ -144,9 +345,59 @@ class Gameboy
     // Write the contents of sram to a binary .sav file in save_dir_
     void write_save(const std::vector<uint8_t> &sram);
 
+    // Copy the emulation state of other. Both mutexes must be held.
+    void copy_state(const Gameboy &other);
+
     // Runs the emulator. This is passed to emu_thread_ in run_concurrently().
     void run();
 
+    // Apply inputs queued by press() and release() (recording them if a movie is recording).
+    void apply_queued_input();
+
+    // Replay movie inputs and record or verify state hashes due at the current cycle.
+    void update_movie();
+
+    // CPU memory bus: memory_read() and memory_write(), charged to the profiler when
+    // profiling.
+    uint8_t bus_read(uint16_t adr);
+    void bus_write(uint8_t b, uint16_t adr);
+
+    // step() without handling exceptions
+    size_t step_instructions(size_t n);
+
+    // Write the flight recorder and what failed to crash_dump_path_.
+    void write_crash_dump(const std::exception &e) const;
+
+    // Copy the current state into the history, reusing the oldest snapshot when full.
+    void take_snapshot();
+
+    // Forget history from after the current position, which re-execution can't reproduce
+    // once emulation continues with new input.
+    void truncate_history();
+
+    // Newest snapshot from before cycle, nullptr if there is none.
+    const Gameboy *snapshot_before(uint64_t cycle) const;
+
+    // Replay without presenting frames, playing audio, calling the debug callback, tracing,
+    // counting into the execution histogram or reporting to the call profiler.
+    void begin_replay();
+    void end_replay();
+
+    // Restore a snapshot to replay from, with no pending break.
+    void replay_from(const Gameboy &snapshot);
+
+    // Apply logged input due at the current cycle and execute an instruction.
+    void replay_step();
+
+    // Forget the breakpoint or watchpoint stop replay_step() ran into.
+    void clear_stop();
+
+    // trace_record() without locking
+    Cpu_trace::Record make_trace_record() const;
+
+    // Record a hit if a watchpoint matches an access to a trapped page.
+    void watch(uint16_t adr, uint8_t b, Watchpoints::Access access);
+
     private:
     // Title of currently loaded ROM
     std::string rom_title_ {};
@@ -161,6 +412,9 @@ class Gameboy
     // Directory to where .sav files are saved
     std::string save_dir_ {"saves"};
 
+    // Write modified SRAM to a .sav file on destruction (off for clones)
+    bool write_save_on_exit_ {true};
+
     // Option to force DMG mode on CGB cartridges
     bool force_dmg_ {false};
 
@@ -185,14 +439,82 @@ class Gameboy
     // Optional callback function to be executed after each CPU instruction when in debug mode
     std::function<bool()> cpu_debug_callback_;
 
-    // Assigned by the return value of debug_callback_ to indicate if emulation should break
+    // Set when emulation breaks, at a breakpoint or because debug_callback_ returned true
     bool debug_break_ {false};
 
+    // Checked before every instruction, whether or not debug mode is on
+    Breakpoints breakpoints_ {};
+    bool breakpoints_enabled_ {true};
+    // The instruction at the breakpoint emulation stopped at runs without breaking again
+    bool skip_breakpoint_ {false};
+
+    // Only accesses to pages flagged by watchpoints_ leave the fast path of bus_read() and
+    // bus_write()
+    Watchpoints watchpoints_ {};
+    std::optional<Watchpoints::Hit> watch_hit_ {};
+    // Set by watch(), checked once the current instruction completes
+    bool watch_pending_ {false};
+    // PC of the instruction being executed, reported in hits
+    uint16_t instruction_pc_ {0};
+
+    std::shared_ptr<Cpu_trace> cpu_trace_ {};
+
+    // Snapshots for reverse debugging, oldest first, and the input applied since the oldest
+    std::deque<std::unique_ptr<Gameboy>> history_ {};
+    size_t history_size_ {0}; // maximum number of snapshots, 0 when disabled
+    uint64_t history_interval_ {0};
+    uint64_t next_snapshot_ {UINT64_MAX}; // elapsed_cycles_ of the next snapshot
+    std::vector<Movie::Input_event> input_log_ {};
+    // State of a replay in progress
+    bool replaying_ {false};
+    size_t replay_input_ {0}; // next input_log_ entry to apply
+    Renderer *replay_renderer_ {nullptr};
+    std::shared_ptr<Speaker> replay_speaker_ {};
+    bool replay_debug_mode_ {false};
+    bool replay_breakpoints_enabled_ {true};
+    std::shared_ptr<Cpu_trace> replay_trace_ {};
+    bool replay_paused_ {false};
+    Execution_histogram *replay_histogram_ {nullptr};
+    Call_profiler *replay_call_profiler_ {nullptr};
+
+    // Always recording, see step()
+    Flight_recorder flight_recorder_ {};
+    std::string crash_dump_path_ {}; // per instance, not copied by copy_state()
+
+    // Cycles emulated since the last reset (see elapsed_cycles())
+    uint64_t elapsed_cycles_ {0};
+
+    // Inputs queued by press() and release(), applied by the emulation thread in step()
+    std::vector<std::pair<Joypad::Input, bool>> input_queue_;
+    std::mutex input_mutex_;
+    std::atomic<bool> input_pending_ {false};
+
+    enum class Movie_mode { None, Recording, Playing };
+    Movie_mode movie_mode_ {Movie_mode::None};
+    Movie movie_ {};
+    // elapsed_cycles_ when recording/playback started, movie cycles are relative to this
+    uint64_t movie_start_ {0};
+    uint64_t next_checkpoint_ {0};
+    size_t movie_input_ {0}, movie_checkpoint_ {0};
+    bool movie_desynced_ {false};
+
+    // Only read and written with mutex_ held or on the emulation thread.
+    bool profiling_ {false};
+    std::unique_ptr<Profiler> profiler_ {};
+
+    // Counts filled by cpu_ (see set_execution_histogram())
+    std::unique_ptr<Execution_histogram> histogram_ {};
+    // Bits set by cpu_ (see set_coverage())
+    std::unique_ptr<Coverage> coverage_ {};
+
+    // Calls and returns reported by cpu_ (see set_call_profiling())
+    std::unique_ptr<Call_profiler> call_profiler_ {};
+
 
 	Processor cpu_ 
 	{
-        [this](uint16_t adr){ return this->memory_read(adr); }, // memory read callback
-        [this](uint8_t b, uint16_t adr){ this->memory_write(b, adr); } // memory write callback
+        [this](uint16_t adr){ return this->bus_read(adr); }, // memory read callback
+        [this](uint8_t b, uint16_t adr){ this->bus_write(b, adr); } // memory write callback
     };
     Ppu ppu_
     {
@@ -201,11 +523,14 @@ class Gameboy
         // reference to CPU so PPU can request LCD, STAT, VBLANK interrupts
         cpu_
     };
-    Timer timer_ {cpu_}; // reference to CPU so timer can request Timer interrupt
+    // reference to CPU so timer can request Timer interrupt, and to the elapsed cycles the
+    // timer's counter is a function of
+    Timer timer_ {cpu_, elapsed_cycles_};
     Joypad joypad_ {cpu_}; // reference to CPU so joypad can request Joypad interrupt
     Apu apu_ {};
+    Serial serial_ {cpu_}; // reference to CPU so serial can request Serial interrupt
     // references to other components so that memory bus can access their internal registers
-    Memory memory_ { cpu_, ppu_, timer_, joypad_, apu_};
+    Memory memory_ { cpu_, ppu_, timer_, joypad_, apu_, serial_};
 };
 
 
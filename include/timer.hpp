@@ -1,32 +1,64 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace qtboy
 {
 
 class Processor;
 
+// DIV, TIMA, TMA and TAC modelled from the 16-bit system counter, which is a function of the
+// absolute cycle time (the clock passed to the constructor). DIV is the upper byte of the
+// counter and TIMA counts falling edges of the counter bit selected by TAC, so both are
+// computed when read instead of being ticked every instruction. The timer only has to run
+// when the clock reaches next_event(), the exact cycle TIMA overflows next.
 class Timer
 {
     public:
-    Timer(Processor &p);
+    // clock must hold the current cycle time for as long as the timer exists.
+    Timer(Processor &p, const uint64_t &clock);
 
-    void update(size_t cycles);
-    uint8_t read(uint16_t adr);
+    // Handle every TIMA overflow due at or before the current time (reload TIMA from TMA and
+    // request the Timer interrupt). Only needs calling once clock reaches next_event().
+    void update();
+
+    // Cycle time of the next TIMA overflow (UINT64_MAX if the timer is stopped).
+    uint64_t next_event() const { return next_overflow_; }
+
+    uint8_t read(uint16_t adr) const;
+    // The 16-bit system counter at the current time. DIV only shows its upper byte.
+    uint16_t system_counter() const { return static_cast<uint16_t>(counter()); }
     void write(uint8_t b, uint16_t adr);
     void reset();
 
+    // Copy the registers and counter of another timer. The clocks of both timers must agree
+    // (they do after Gameboy::copy_state()).
+    void copy_state(const Timer &other);
+
     private:
-    void tima_overflow();
+    // System counter at the current time, unwrapped (bits above 15 count DIV overflows).
+    uint64_t counter() const { return clock_ + counter_offset_; }
+    bool enabled() const { return tac_ & 4; }
+    // counter cycles per TIMA increment for the current TAC
+    uint64_t period() const { return FREQUENCIES[tac_ & 3]; }
+    // TIMA increments between counter values from and to
+    uint64_t ticks(uint64_t from, uint64_t to) const;
+    // Bring tima_ up to date with the current time.
+    void sync();
+    // Increment TIMA once (TAC/DIV write glitch), handling an overflow.
+    void increment();
+    void overflow();
+    void predict();
 
     private:
     Processor &cpu_;
-    int div_ticks_ {0};
-    int tima_ticks_ {0};
+    const uint64_t &clock_;
+    uint64_t counter_offset_ {0}; // system counter = clock_ + counter_offset_
+    uint64_t tima_counter_ {0}; // system counter value tima_ was last brought up to date at
+    uint64_t next_overflow_ {UINT64_MAX};
     uint8_t tima_ {0}, tma_ {0}; // TIMA ff05, ff06
     uint8_t tac_ {0}; // ff07
-    uint16_t div_ {0};
     static constexpr uint16_t FREQUENCIES[] {1024, 16, 64, 256};
 };
 
@@ -0,0 +1,82 @@
+#ifndef WATCHPOINTS_HPP
+#define WATCHPOINTS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "condition.hpp"
+
+namespace qtboy
+{
+
+// Read, write and execute watchpoints on address ranges, optionally qualified by the bank
+// mapped at the address (see Memory::bank()). Every 256 byte page of the memory map has a
+// set of trap flags, the accesses some watchpoint covering the page watches. The memory
+// bus only tests the flags of the page it accesses, and ranges are only looked at when a
+// flag is set, so watchpoints cost nothing outside the pages they cover. A watchpoint's
+// condition is only evaluated once an access matches its range.
+class Watchpoints
+{
+    public:
+    enum Access : uint8_t
+    {
+        Read = 1, // data reads, not opcode or operand fetches
+        Write = 2,
+        Execute = 4,
+    };
+
+    // Bank of a watchpoint that triggers whatever bank is mapped.
+    static constexpr int ANY_BANK {-1};
+
+    struct Watchpoint
+    {
+        int id;
+        uint16_t first, last; // inclusive
+        uint8_t access; // Access bits
+        int bank;
+        std::string condition; // empty if unconditional
+    };
+
+    // An access that triggered a watchpoint.
+    struct Hit
+    {
+        int id;
+        uint16_t adr;
+        uint8_t value; // byte read, written or opcode executed
+        Access access;
+        uint16_t pc; // address of the instruction that made the access
+    };
+
+    // Watch first-last (inclusive) for the given combination of Access bits, triggering only
+    // when condition (see Condition) holds. Returns an id for remove(). Throws
+    // std::runtime_error if condition doesn't compile.
+    int add(uint16_t first, uint16_t last, uint8_t access, int bank = ANY_BANK,
+            const std::string &condition = {});
+    void remove(int id);
+    void clear();
+    const std::vector<Watchpoint> &list() const { return watchpoints_; }
+
+    // True if a watchpoint on the page of adr watches access.
+    bool trapped(uint16_t adr, Access access) const { return pages_[adr >> 8] & access; }
+
+    // The watchpoint an access to adr triggers while bank is mapped there, nullptr if none.
+    // Conditions are evaluated against cpu and memory as they are during the access. Only
+    // call if trapped(adr, access).
+    const Watchpoint *match(uint16_t adr, uint16_t bank, Access access, const Processor &cpu,
+                            const Memory &memory) const;
+
+    private:
+    // Recompute the trap flags of every page.
+    void update_pages();
+
+    std::array<uint8_t, 256> pages_ {};
+    std::vector<Watchpoint> watchpoints_ {};
+    std::vector<Condition> conditions_ {}; // of each watchpoint
+    int next_id_ {0};
+};
+
+}
+
+#endif // WATCHPOINTS_HPP
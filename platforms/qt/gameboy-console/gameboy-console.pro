@@ -6,45 +6,77 @@ CONFIG += c++17 console
 INCLUDEPATH += ../../../include
 
 SOURCES += \
+    ../../../src/analysis.cpp \
+    ../../../src/batch_env.cpp \
+    ../../../src/breakpoints.cpp \
+    ../../../src/call_profiler.cpp \
     ../../../src/cartridge.cpp \
+    ../../../src/condition.cpp \
+    ../../../src/coverage.cpp \
+    ../../../src/cpu_trace.cpp \
     ../../../src/debugger.cpp \
     ../../../src/disassembler.cpp \
+    ../../../src/disassembly_cache.cpp \
     ../../../src/exception.cpp \
+    ../../../src/execution_histogram.cpp \
+    ../../../src/flight_recorder.cpp \
+    ../../../src/executor.cpp \
     ../../../src/instructions.cpp \
+    ../../../src/link_cable.cpp \
     ../../../src/main.cpp \
     ../../../src/mbc1.cpp \
     ../../../src/memory.cpp \
+    ../../../src/movie.cpp \
     ../../../src/ppu.cpp \
     ../../../src/processor.cpp \
+    ../../../src/profiler.cpp \
     ../../../src/ram.cpp \
     ../../../src/rom.cpp \
+    ../../../src/serial.cpp \
     ../../../src/system.cpp \
-    ../../../src/timer.cpp
+    ../../../src/timer.cpp \
+    ../../../src/watchpoints.cpp
 
 HEADERS += \
+    ../../../include/analysis.hpp \
     ../../../include/apu.hpp \
     ../../../include/audio_types.hpp \
+    ../../../include/batch_env.hpp \
+    ../../../include/breakpoints.hpp \
+    ../../../include/call_profiler.hpp \
     ../../../include/cartridge.hpp \
+    ../../../include/condition.hpp \
+    ../../../include/coverage.hpp \
+    ../../../include/cpu_trace.hpp \
     ../../../include/debug_types.hpp \
     ../../../include/debugger.hpp \
     ../../../include/disassembler.hpp \
+    ../../../include/disassembly_cache.hpp \
     ../../../include/exception.hpp \
+    ../../../include/execution_histogram.hpp \
+    ../../../include/flight_recorder.hpp \
+    ../../../include/executor.hpp \
     ../../../include/graphic_types.hpp \
     ../../../include/instruction_info.hpp \
     ../../../include/joypad.hpp \
+    ../../../include/link_cable.hpp \
     ../../../include/json_opcodes.hpp \
     ../../../include/memory.hpp \
     ../../../include/memory_bank_controller.hpp \
+    ../../../include/movie.hpp \
     ../../../include/noise_channel.hpp \
     ../../../include/ppu.hpp \
     ../../../include/processor.hpp \
+    ../../../include/profiler.hpp \
     ../../../include/ram.hpp \
     ../../../include/register_pair.hpp \
     ../../../include/renderer.hpp \
     ../../../include/rom.hpp \
+    ../../../include/serial.hpp \
     ../../../include/speaker.hpp \
     ../../../include/square_channel.hpp \
     ../../../include/system.hpp \
     ../../../include/thread_safe_system.hpp \
     ../../../include/timer.hpp \
+    ../../../include/watchpoints.hpp \
     ../../../include/wave_channel.hpp
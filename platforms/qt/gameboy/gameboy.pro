@@ -14,31 +14,47 @@ INCLUDEPATH += ../../../include \
 LIBS += -L"C:\Program Files\mingw-w64\dev_lib\lib" # -lmingw32 -lSDL2main -lSDL2 # path to SDL2 libraries
 
 SOURCES += \
+    ../../../src/analysis.cpp \
     ../../../src/apu.cpp \
     ../../../src/audio_types.cpp \
+    ../../../src/batch_env.cpp \
+    ../../../src/breakpoints.cpp \
+    ../../../src/call_profiler.cpp \
     ../../../src/cartridge.cpp \
+    ../../../src/condition.cpp \
+    ../../../src/coverage.cpp \
+    ../../../src/cpu_trace.cpp \
     ../../../src/debugger.cpp \
     ../../../src/disassembler.cpp \
+    ../../../src/disassembly_cache.cpp \
     ../../../src/exception.cpp \
+    ../../../src/execution_histogram.cpp \
+    ../../../src/flight_recorder.cpp \
+    ../../../src/executor.cpp \
     ../../../src/graphic_types.cpp \
     ../../../src/instructions.cpp \
     ../../../src/joypad.cpp \
+    ../../../src/link_cable.cpp \
     ../../../src/mbc1.cpp \
     ../../../src/mbc2.cpp \
     ../../../src/mbc3.cpp \
     ../../../src/mbc5.cpp \
     ../../../src/memory.cpp \
+    ../../../src/movie.cpp \
     ../../../src/noise_channel.cpp \
     ../../../src/ppu.cpp \
     ../../../src/processor.cpp \
+    ../../../src/profiler.cpp \
     ../../../src/ram.cpp \
     ../../../src/raw_audio.cpp \
     ../../../src/reusable_thread.cpp \
     ../../../src/rom.cpp \
+    ../../../src/serial.cpp \
     ../../../src/speaker.cpp \
     ../../../src/square_channel.cpp \
     ../../../src/system.cpp \
     ../../../src/timer.cpp \
+    ../../../src/watchpoints.cpp \
     ../../../src/wave_channel.cpp \
     ../src/breakpoint_window.cpp \
     ../src/debuggerwindow.cpp \
@@ -56,30 +72,46 @@ SOURCES += \
     ../src/window_tab.cpp
 
 HEADERS += \
+    ../../../include/analysis.hpp \
     ../../../include/apu.hpp \
+    ../../../include/batch_env.hpp \
+    ../../../include/breakpoints.hpp \
+    ../../../include/call_profiler.hpp \
     ../../../include/cartridge.hpp \
+    ../../../include/condition.hpp \
+    ../../../include/coverage.hpp \
+    ../../../include/cpu_trace.hpp \
     ../../../include/debug_types.hpp \
     ../../../include/debugger.hpp \
     ../../../include/disassembler.hpp \
+    ../../../include/disassembly_cache.hpp \
     ../../../include/exception.hpp \
+    ../../../include/execution_histogram.hpp \
+    ../../../include/flight_recorder.hpp \
+    ../../../include/executor.hpp \
     ../../../include/graphic_types.hpp \
     ../../../include/instruction_info.hpp \
     ../../../include/joypad.hpp \
+    ../../../include/link_cable.hpp \
     ../../../include/memory.hpp \
     ../../../include/memory_bank_controller.hpp \
+    ../../../include/movie.hpp \
     ../../../include/noise_channel.hpp \
     ../../../include/ppu.hpp \
     ../../../include/processor.hpp \
+    ../../../include/profiler.hpp \
     ../../../include/ram.hpp \
     ../../../include/raw_audio.hpp \
     ../../../include/register_pair.hpp \
     ../../../include/renderer.hpp \
     ../../../include/reusable_thread.hpp \
     ../../../include/rom.hpp \
+    ../../../include/serial.hpp \
     ../../../include/speaker.hpp \
     ../../../include/square_channel.hpp \
     ../../../include/system.hpp \
     ../../../include/timer.hpp \
+    ../../../include/watchpoints.hpp \
     ../../../include/wave_channel.hpp \
     ../include/breakpoint_window.h \
     ../include/custom_palette_window.h \
@@ -60,6 +60,13 @@ class MainWindow : public QMainWindow
     // Open file dialog to choose a ROM file
     void openRom();
 
+    // Restart the current ROM and record input into a movie. Unchecking stops recording
+    // and asks where to save the movie.
+    void toggleRecordMovie(bool);
+
+    // Restart the current ROM and play back a movie file chosen in a file dialog.
+    void playMovie();
+
     // Create debugger window
     void showDebugger();
 
@@ -74,10 +81,18 @@ class MainWindow : public QMainWindow
     void toggleForceDmg(bool);
     void toggleSound(bool);
 
+    // Start profiling where emulation time goes. Unchecking stops profiling and asks where
+    // to save the per-frame breakdown as CSV.
+    void toggleProfiling(bool);
+
     private:
     // load the cartridge at fileName onto the Gameboy.
     void loadRom(const QString &fileName);
 
+    // Reset the Gameboy and reload the current ROM without starting it, so a movie can
+    // start at power on. Returns false if no ROM has been opened.
+    bool restartRom();
+
     // Create a new menu in the toolbar.
     QMenu *createMenu(const QString &name);
 
@@ -124,6 +139,9 @@ class MainWindow : public QMainWindow
     // Control mapping
     Controls controls_;
 
+    // File > Record Movie, unchecked again if recording can't start
+    QAction *recordMovieAct_ {nullptr};
+
     /*
     // Windows that can be opened through toolbar actions. An instance is only created on the first
     // open request. Subsequent open/close requests only show/hide the window.
@@ -126,10 +126,8 @@ void DebuggerWindow::update_info(const qtboy::Cpu_dump &dump,
     rom_viewer_->make_selection(dump.pc, Qt::cyan);
     stack_viewer_->make_selection(dump.sp, Qt::cyan);
     // select lines with breakpoints
-    std::unordered_map<uint16_t, bool> breakpoints = debugger_.breakpoints();
-    for (const auto &b : breakpoints)
-        if (b.second)
-            rom_viewer_->make_selection(b.first, Qt::red);
+    for (const qtboy::Breakpoints::Breakpoint &b : debugger_.breakpoints())
+        rom_viewer_->make_selection(b.adr, Qt::red);
     // higlight selected lines
     rom_viewer_->highlight_lines();
     stack_viewer_->highlight_lines();
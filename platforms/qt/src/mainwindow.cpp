@@ -5,6 +5,7 @@
 #include "qt_speaker.h"
 
 #include <chrono>
+#include <fstream>
 #include <sstream>
 
 MainWindow::MainWindow(QWidget *parent,
@@ -25,6 +26,7 @@ MainWindow::MainWindow(QWidget *parent,
 
     system_->set_renderer(renderer_);
     system_->set_speaker(speaker_);
+    system_->set_crash_dump_path("flight_recorder.txt");
 
     fpsTimer_->setInterval(1000);
     fpsTimer_->callOnTimeout(this, &MainWindow::updateFps);
@@ -39,9 +41,18 @@ void MainWindow::loadRom(const QString &fileName)
 {
     system_->reset();
     system_->load_cartridge(fileName.toStdString());
+    curRom = fileName;
     system_->run_concurrently();
 }
 
+bool MainWindow::restartRom()
+{
+    if (curRom.isEmpty())
+        return false;
+    system_->reset();
+    return system_->load_cartridge(curRom.toStdString());
+}
+
 void MainWindow::keyPressEvent(QKeyEvent *event)
 {
     auto key = event->key();
@@ -116,6 +127,53 @@ void MainWindow::openRom()
         loadRom(fileName);
 }
 
+void MainWindow::toggleRecordMovie(bool b)
+{
+    if (b)
+    {
+        if (!restartRom())
+        {
+            const QSignalBlocker blocker {recordMovieAct_};
+            recordMovieAct_->setChecked(false);
+            QMessageBox::warning(this, tr("Record Movie"), tr("Open a ROM before recording."));
+            return;
+        }
+        system_->record_movie();
+        system_->run_concurrently();
+        return;
+    }
+    qtboy::Movie movie {system_->stop_movie()};
+    if (movie.checkpoints().empty())
+        return; // nothing was recorded
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Movie"), QString(),
+                                                    tr("QtBoy movies (*.qbm)"));
+    if (!fileName.isEmpty() && !movie.save(fileName.toStdString()))
+        QMessageBox::warning(this, tr("Save Movie"), tr("Could not write %1.").arg(fileName));
+}
+
+void MainWindow::playMovie()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Play Movie"), QString(),
+                                                    tr("QtBoy movies (*.qbm)"));
+    if (fileName.isEmpty())
+        return;
+    try
+    {
+        qtboy::Movie movie {qtboy::Movie::load(fileName.toStdString())};
+        if (!restartRom())
+        {
+            QMessageBox::warning(this, tr("Play Movie"), tr("Open a ROM before playing a movie."));
+            return;
+        }
+        system_->play_movie(std::move(movie));
+        system_->run_concurrently();
+    }
+    catch (const std::exception &e)
+    {
+        QMessageBox::warning(this, tr("Play Movie"), e.what());
+    }
+}
+
 void MainWindow::showDebugger()
 {
     /*
@@ -156,6 +214,27 @@ void MainWindow::toggleSound(bool b)
     system_->toggle_sound(b);
 }
 
+void MainWindow::toggleProfiling(bool b)
+{
+    if (b)
+    {
+        system_->set_profiling(true);
+        return;
+    }
+    system_->set_profiling(false);
+    const qtboy::Profiler *profiler {system_->profiler()};
+    if (!profiler || profiler->frame_count() == 0)
+        return; // no frame was profiled
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Profile"), QString(),
+                                                    tr("CSV files (*.csv)"));
+    if (fileName.isEmpty())
+        return;
+    std::ofstream os {fileName.toStdString()};
+    profiler->write_csv(os);
+    if (!os)
+        QMessageBox::warning(this, tr("Save Profile"), tr("Could not write %1.").arg(fileName));
+}
+
 QMenu *MainWindow::createMenu(const QString &name)
 {
     return menuBar()->addMenu(name);
@@ -191,6 +270,9 @@ void MainWindow::createActions()
     QMenu *fileMenu = createMenu(tr("&File"));
     QAction *openAct = createSingleAction(tr("&Open"), fileMenu, &MainWindow::openRom);
     openAct->setShortcuts(QKeySequence::Open);
+    recordMovieAct_ = createCheckableAction(tr("&Record Movie"), fileMenu,
+                                            &MainWindow::toggleRecordMovie);
+    createSingleAction(tr("&Play Movie..."), fileMenu, &MainWindow::playMovie);
 
     // Options menu
     QMenu *optionsMenu = createMenu(tr("&Options"));
@@ -205,6 +287,9 @@ void MainWindow::createActions()
                           optionsMenu,
                           &MainWindow::toggleSound,
                           true);
+    createCheckableAction(tr("Profile"),
+                          optionsMenu,
+                          &MainWindow::toggleProfiling);
 
     /*
     // Tools menu
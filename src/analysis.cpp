@@ -0,0 +1,214 @@
+#include "analysis.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+static constexpr uint16_t TITLE {0x134};
+static constexpr uint16_t TITLE_LENGTH {16};
+static constexpr uint16_t HEADER_CHECKSUM {0x14e};
+
+// The header title, up to the first NUL or non-ASCII byte (CGB ROMs have the CGB flag in the
+// last byte).
+static std::string rom_title(const Rom &rom)
+{
+    std::string title;
+    if (rom.size() < HEADER_CHECKSUM + 2u)
+        return title;
+    for (uint16_t adr {TITLE}; adr < TITLE + TITLE_LENGTH; ++adr)
+    {
+        const uint8_t c {rom.read(0, adr)};
+        if (c < 0x20 || c > 0x7e)
+            break;
+        title += static_cast<char>(c);
+    }
+    return title;
+}
+
+Analysis::Analysis(const Rom &rom)
+    : checksum_ {checksum(rom)}, title_ {rom_title(rom)}, rom_banks_ {rom.banks()},
+      coverage_ {rom.banks()}
+{}
+
+uint16_t Analysis::checksum(const Rom &rom)
+{
+    if (rom.size() < HEADER_CHECKSUM + 2u)
+        return 0;
+    return static_cast<uint16_t>(rom.read(0, HEADER_CHECKSUM) << 8
+                                 | rom.read(0, HEADER_CHECKSUM + 1));
+}
+
+std::string Analysis::file_name(const Rom &rom)
+{
+    std::string name {rom_title(rom)};
+    for (char &c : name)
+    {
+        const bool keep {(c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')
+                         || (c >= 'a' && c <= 'z') || c == '-' || c == '_'};
+        if (!keep)
+            c = '_';
+    }
+    if (name.empty())
+        name = "ROM";
+    char key[8];
+    std::snprintf(key, sizeof key, "-%04x", checksum(rom));
+    return name + key + ".analysis";
+}
+
+bool Analysis::matches(const Rom &rom) const
+{
+    return checksum(rom) == checksum_ && rom_title(rom) == title_ && rom.banks() == rom_banks_;
+}
+
+void Analysis::set_label(uint16_t bank, uint16_t adr, const std::string &name)
+{
+    if (name.empty())
+        labels_.erase(key(bank, adr));
+    else
+        labels_[key(bank, adr)] = name;
+}
+
+const std::string *Analysis::label(uint16_t bank, uint16_t adr) const
+{
+    const auto i {labels_.find(key(bank, adr))};
+    return i == labels_.end() ? nullptr : &i->second;
+}
+
+std::vector<Analysis::Label> Analysis::labels() const
+{
+    std::vector<Label> out;
+    out.reserve(labels_.size());
+    for (const auto &[k, name] : labels_)
+        out.push_back({static_cast<uint16_t>(k >> 16), static_cast<uint16_t>(k), name});
+    return out;
+}
+
+// Parse a hex number of up to 4 digits from [first, last), returns the end of it or nullptr.
+static const char *parse_hex(const char *first, const char *last, uint16_t &x)
+{
+    const auto [end, error] = std::from_chars(first, last, x, 16);
+    return error == std::errc {} && end - first <= 4 ? end : nullptr;
+}
+
+std::size_t Analysis::import_sym(const std::string &path)
+{
+    std::ifstream in {path};
+    if (!in)
+        throw std::runtime_error {"Analysis: could not open symbol file " + path};
+    std::vector<Label> read;
+    std::string line;
+    for (std::size_t n {1}; std::getline(in, line); ++n)
+    {
+        const std::size_t begin {line.find_first_not_of(" \t\r")};
+        if (begin == std::string::npos || line[begin] == ';')
+            continue;
+        const char *p {line.data() + begin};
+        const char *const end {line.data() + line.size()};
+        Label l {};
+        p = parse_hex(p, end, l.bank);
+        if (p && p < end && *p == ':')
+            p = parse_hex(p + 1, end, l.adr);
+        else
+            p = nullptr;
+        if (p && p < end && (*p == ' ' || *p == '\t'))
+        {
+            const std::string rest {p, end};
+            const std::size_t name {rest.find_first_not_of(" \t")};
+            if (name != std::string::npos)
+                l.name = rest.substr(name, rest.find_first_of(" \t\r;", name) - name);
+        }
+        if (l.name.empty())
+            throw std::runtime_error {"Analysis: " + path + " line " + std::to_string(n)
+                                      + ": expected bank:address name"};
+        read.push_back(std::move(l));
+    }
+    for (const Label &l : read)
+        set_label(l.bank, l.adr, l.name);
+    return read.size();
+}
+
+void Analysis::save(const std::string &path) const
+{
+    std::ofstream out {path, std::ios::binary};
+    Header h {MAGIC, VERSION, checksum_, 0, static_cast<uint32_t>(rom_banks_),
+              static_cast<uint32_t>(entries_.size()), static_cast<uint32_t>(labels_.size()), {}};
+    title_.copy(h.title.data(), h.title.size());
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char *>(entries_.data()),
+              static_cast<std::streamsize>(entries_.size() * sizeof(Disassembly_cache::Entry)));
+    coverage_.save(out);
+    for (const auto &[k, name] : labels_)
+    {
+        const Label_header l {static_cast<uint16_t>(k >> 16), static_cast<uint16_t>(k),
+                              static_cast<uint16_t>(std::min<std::size_t>(name.size(), 0xffff))};
+        out.write(reinterpret_cast<const char *>(&l), sizeof(l));
+        out.write(name.data(), l.length);
+    }
+    if (!out)
+        throw std::runtime_error {"Analysis: could not write analysis file " + path};
+}
+
+void Analysis::load(const std::string &path)
+{
+    std::ifstream in {path, std::ios::binary};
+    if (!in)
+        throw std::runtime_error {"Analysis: could not open analysis file " + path};
+    Header h {};
+    in.read(reinterpret_cast<char *>(&h), sizeof(h));
+    if (!in || h.magic != MAGIC)
+        throw std::runtime_error {"Analysis: " + path + " is not an analysis file"};
+    if (h.version != VERSION)
+        throw std::runtime_error {"Analysis: unsupported analysis file " + path};
+    const std::string title {h.title.data(), std::find(h.title.begin(), h.title.end(), '\0')};
+    if (h.checksum != checksum_ || title != title_ || h.rom_banks != rom_banks_)
+        throw std::runtime_error {"Analysis: " + path + " is the analysis of another ROM"};
+    const auto truncated = [&path]{
+        return std::runtime_error {"Analysis: analysis file " + path + " is truncated"};
+    };
+    // the counts in the header are only trusted as far as the file is long enough for them
+    const std::streampos start {in.tellg()};
+    in.seekg(0, std::ios::end);
+    const std::streamoff left {in.tellg() - start};
+    in.seekg(start);
+    if (!in || left < 0 || static_cast<uint64_t>(h.entries) * sizeof(Disassembly_cache::Entry)
+                               > static_cast<uint64_t>(left))
+        throw truncated();
+    // read everything before replacing anything
+    std::vector<Disassembly_cache::Entry> entries(h.entries);
+    in.read(reinterpret_cast<char *>(entries.data()),
+            static_cast<std::streamsize>(entries.size() * sizeof(Disassembly_cache::Entry)));
+    if (!in)
+        throw truncated();
+    Coverage coverage {rom_banks_};
+    try
+    {
+        coverage.load(in);
+    }
+    catch (const std::runtime_error &e)
+    {
+        throw std::runtime_error {std::string {e.what()} + ": " + path};
+    }
+    std::map<uint32_t, std::string> labels;
+    for (uint32_t i {0}; i < h.labels; ++i)
+    {
+        Label_header l {};
+        in.read(reinterpret_cast<char *>(&l), sizeof(l));
+        if (!in)
+            throw truncated();
+        std::string name(l.length, '\0');
+        in.read(name.data(), l.length);
+        if (!in)
+            throw truncated();
+        labels[key(l.bank, l.adr)] = std::move(name);
+    }
+    entries_ = std::move(entries);
+    coverage_ = std::move(coverage);
+    labels_ = std::move(labels);
+}
+
+}
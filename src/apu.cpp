@@ -15,6 +15,21 @@ Apu::Apu()
     : samples_(SAMPLE_SIZE)
 {}
 
+void Apu::copy_state(const Apu &other)
+{
+    square1_ = other.square1_;
+    square2_ = other.square2_;
+    wave_ = other.wave_;
+    noise_ = other.noise_;
+    volume_ = other.volume_;
+    output_ = other.output_;
+    enable_ = other.enable_;
+    downsample_cnt_ = other.downsample_cnt_;
+    frame_sequence_cnt = other.frame_sequence_cnt;
+    frame_sequencer_ = other.frame_sequencer_;
+    samples_.clear();
+}
+
 void Apu::reset()
 {
     square1_ = {};
@@ -63,8 +78,9 @@ void Apu::tick(std::size_t cycles)
         square2_.tick(1);
         wave_.tick(1);
         noise_.tick(1);
-        // take a sample only once ever DOWNSAMPLE_FREQ cycles
-        if (--downsample_cnt_ <= 0)
+        // take a sample only once ever DOWNSAMPLE_FREQ cycles (headless instances without a
+        // speaker don't take samples at all)
+        if (speaker_ && --downsample_cnt_ <= 0)
         {
             downsample_cnt_ = DOWNSAMPLE_FREQ;
             uint16_t left_mix = 0, right_mix = 0;
@@ -98,7 +114,7 @@ void Apu::tick(std::size_t cycles)
 
 int Apu::samples_queued()
 {
-    return speaker_->samples_queued();
+    return speaker_ ? speaker_->samples_queued() : 0;
 }
 
 uint8_t Apu::read_reg(uint16_t adr)
@@ -150,7 +166,8 @@ void Apu::set_speaker(std::shared_ptr<Speaker> s)
 
 void Apu::toggle_sound(bool b)
 {
-    speaker_->toggle(b);
+    if (speaker_)
+        speaker_->toggle(b);
 }
 
 std::pair<uint8_t, uint8_t> Apu::mix_samples(uint8_t square1,
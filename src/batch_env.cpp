@@ -0,0 +1,160 @@
+#include "batch_env.hpp"
+#include "system.hpp"
+#include "renderer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+class Batch_env::Frame_capture : public Renderer
+{
+    public:
+    explicit Frame_capture(Color *out)
+        : out_ {out}
+    {}
+
+    void draw_texture(const Texture &t, unsigned x, unsigned y) override
+    {
+        if (y >= FRAME_HEIGHT)
+            return;
+        const unsigned w {std::min(t.width(), FRAME_WIDTH - std::min(x, FRAME_WIDTH))};
+        Color *line {back_.data() + y * FRAME_WIDTH + x};
+        for (unsigned i {0}; i < w; ++i)
+            line[i] = t.pixel(i);
+    }
+
+    // called at VBLANK: publish the finished frame so a step never returns a torn one
+    void present_screen() override
+    {
+        std::copy(back_.begin(), back_.end(), out_);
+    }
+
+    private:
+    Color *out_;
+    std::vector<Color> back_ = std::vector<Color>(FRAME_SIZE);
+};
+
+Batch_env::Batch_env(const Gameboy &start, std::size_t k, Options opt)
+    : opt_ {std::move(opt)},
+      start_ {start.clone()},
+      held_(k, 0),
+      frames_(opt_.output == Ppu::Output::Rgb ? k * FRAME_SIZE : 0, 0),
+      observations_(opt_.output == Ppu::Output::Rgb ? 0 : k * observation_size(), 0),
+      ram_(k * opt_.ram_addresses.size(), 0),
+      executor_ {opt_.workers}
+{
+    if (opt_.frame_skip == 0)
+        throw std::runtime_error {"Batch_env: frame_skip must be at least 1"};
+    for (std::size_t i {0}; i < k; ++i)
+    {
+        std::shared_ptr<Gameboy> g {start_->clone()};
+        if (opt_.output == Ppu::Output::Rgb)
+        {
+            captures_.push_back(std::make_unique<Frame_capture>(frames_.data() + i * FRAME_SIZE));
+            g->set_renderer(captures_.back().get());
+        }
+        else
+        {
+            // the PPU writes 8-bit frames itself, no renderer is involved
+            g->set_output(opt_.output, opt_.output_width, opt_.output_height);
+        }
+        executor_.add(g);
+        instances_.push_back(std::move(g));
+        rngs_.emplace_back(opt_.seed + i);
+        observe(i);
+    }
+}
+
+Batch_env::Batch_env(const Gameboy &start, std::size_t k)
+    : Batch_env(start, k, Options {})
+{}
+
+Batch_env::~Batch_env() = default;
+
+std::size_t Batch_env::size() const
+{
+    return instances_.size();
+}
+
+void Batch_env::step(const std::vector<uint8_t> &actions)
+{
+    if (actions.size() != instances_.size())
+        throw std::runtime_error {"Batch_env: expected one action per instance"};
+    step(actions.data());
+}
+
+void Batch_env::step(const uint8_t *actions)
+{
+    if (opt_.sticky_action_prob <= 0)
+    {
+        for (std::size_t i {0}; i < instances_.size(); ++i)
+            apply(i, actions[i]);
+        executor_.run_frames(opt_.frame_skip);
+    }
+    else
+    {
+        // sticky actions are decided per frame, so frames are run one at a time
+        std::uniform_real_distribution<double> dist {0.0, 1.0};
+        for (unsigned f {0}; f < opt_.frame_skip; ++f)
+        {
+            for (std::size_t i {0}; i < instances_.size(); ++i)
+            {
+                if (dist(rngs_[i]) >= opt_.sticky_action_prob)
+                    apply(i, actions[i]);
+            }
+            executor_.run_frames(1);
+        }
+    }
+    for (std::size_t i {0}; i < instances_.size(); ++i)
+        observe(i);
+}
+
+void Batch_env::reset()
+{
+    for (std::size_t i {0}; i < instances_.size(); ++i)
+        reset(i);
+}
+
+void Batch_env::reset(std::size_t i)
+{
+    // restoring drops queued input, and the start state has no buttons held
+    instances_.at(i)->restore(*start_);
+    held_[i] = 0;
+    observe(i);
+}
+
+void Batch_env::apply(std::size_t i, uint8_t mask)
+{
+    const uint8_t changed = held_[i] ^ mask;
+    if (!changed)
+        return;
+    Gameboy &g {*instances_[i]};
+    for (uint8_t b {0}; b < 8; ++b)
+    {
+        if (!(changed & (1 << b)))
+            continue;
+        if (mask & (1 << b))
+            g.press(static_cast<Joypad::Input>(b));
+        else
+            g.release(static_cast<Joypad::Input>(b));
+    }
+    held_[i] = mask;
+}
+
+void Batch_env::observe(std::size_t i)
+{
+    const std::vector<uint16_t> &adrs {opt_.ram_addresses};
+    uint8_t *out {ram_.data() + i * adrs.size()};
+    Gameboy &g {*instances_[i]};
+    for (std::size_t a {0}; a < adrs.size(); ++a)
+        out[a] = g.memory_read(adrs[a]);
+    if (opt_.output != Ppu::Output::Rgb)
+    {
+        const std::vector<uint8_t> &frame {g.output_frame()};
+        std::copy(frame.begin(), frame.end(), observations_.data() + i * observation_size());
+    }
+}
+
+}
@@ -0,0 +1,124 @@
+#include "breakpoints.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+static void set_bit(uint64_t *bits, uint32_t i, bool b)
+{
+    if (b)
+        bits[i >> 6] |= uint64_t {1} << (i & 63);
+    else
+        bits[i >> 6] &= ~(uint64_t {1} << (i & 63));
+}
+
+void Breakpoints::add(uint16_t adr, int bank, const std::string &condition)
+{
+    if (bank < ANY_BANK || bank > MAX_BANK)
+        throw std::out_of_range {"Breakpoints: bank out of range"};
+    if (condition.empty())
+        conditions_.erase(key(adr, bank));
+    else
+        conditions_[key(adr, bank)] = Condition {condition};
+    if (bank == ANY_BANK)
+    {
+        set_bit(unbanked_.data(), adr, true);
+    }
+    else
+    {
+        const uint32_t i {static_cast<uint32_t>(bank) << 16 | adr};
+        if (banked_.size() <= i >> 6)
+            banked_.resize((static_cast<size_t>(bank) + 1) << 10, 0);
+        set_bit(banked_.data(), i, true);
+    }
+    update(adr);
+}
+
+void Breakpoints::remove(uint16_t adr, int bank)
+{
+    if (bank < ANY_BANK || bank > MAX_BANK)
+        return;
+    conditions_.erase(key(adr, bank));
+    if (bank == ANY_BANK)
+    {
+        set_bit(unbanked_.data(), adr, false);
+    }
+    else
+    {
+        const uint32_t i {static_cast<uint32_t>(bank) << 16 | adr};
+        if (banked_.size() > i >> 6)
+            set_bit(banked_.data(), i, false);
+    }
+    update(adr);
+}
+
+void Breakpoints::clear()
+{
+    any_ = {};
+    unbanked_ = {};
+    banked_.clear();
+    conditions_.clear();
+}
+
+bool Breakpoints::empty() const
+{
+    return std::all_of(any_.begin(), any_.end(), [](uint64_t w) { return w == 0; });
+}
+
+bool Breakpoints::hit(uint16_t adr, uint16_t bank, const Processor &cpu,
+                      const Memory &memory) const
+{
+    if (test(unbanked_.data(), adr) && holds(key(adr, ANY_BANK), cpu, memory))
+        return true;
+    const uint32_t i {static_cast<uint32_t>(bank) << 16 | adr};
+    return banked_.size() > i >> 6 && test(banked_.data(), i)
+            && holds(key(adr, bank), cpu, memory);
+}
+
+bool Breakpoints::holds(uint64_t key, const Processor &cpu, const Memory &memory) const
+{
+    if (conditions_.empty())
+        return true;
+    const auto c {conditions_.find(key)};
+    return c == conditions_.end() || c->second(cpu, memory);
+}
+
+std::vector<Breakpoints::Breakpoint> Breakpoints::list() const
+{
+    auto condition {[this](uint64_t k)
+    {
+        const auto c {conditions_.find(k)};
+        return c == conditions_.end() ? std::string {} : c->second.source();
+    }};
+    std::vector<Breakpoint> out;
+    for (uint32_t adr = 0; adr < 0x10000; ++adr)
+    {
+        if (test(unbanked_.data(), adr))
+        {
+            const uint16_t a {static_cast<uint16_t>(adr)};
+            out.push_back({a, ANY_BANK, condition(key(a, ANY_BANK))});
+        }
+    }
+    for (uint32_t i = 0; i < banked_.size() * 64; ++i)
+    {
+        if (test(banked_.data(), i))
+        {
+            const uint16_t adr {static_cast<uint16_t>(i & 0xffff)};
+            const int bank {static_cast<int>(i >> 16)};
+            out.push_back({adr, bank, condition(key(adr, bank))});
+        }
+    }
+    return out;
+}
+
+void Breakpoints::update(uint16_t adr)
+{
+    bool any {test(unbanked_.data(), adr)};
+    for (uint32_t i = adr; !any && i >> 6 < banked_.size(); i += 0x10000)
+        any = test(banked_.data(), i);
+    set_bit(any_.data(), adr, any);
+}
+
+}
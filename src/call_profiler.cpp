@@ -0,0 +1,120 @@
+#include "call_profiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace qtboy
+{
+
+void Call_profiler::enter(uint16_t bank, uint16_t adr, uint16_t sp, uint32_t cycles)
+{
+    charge(cycles);
+    if (stack_.size() == MAX_DEPTH)
+        return;
+    const uint32_t key {static_cast<uint32_t>(bank) << 16 | adr};
+    const uint64_t edge {static_cast<uint64_t>(node_) << 32 | key};
+    auto it = children_.find(edge);
+    if (it == children_.end())
+    {
+        it = children_.emplace(edge, static_cast<uint32_t>(nodes_.size())).first;
+        nodes_.push_back({key, node_, 0, 0});
+    }
+    node_ = it->second;
+    ++nodes_[node_].calls;
+    stack_.push_back({node_, sp});
+}
+
+void Call_profiler::leave(uint16_t sp, uint32_t cycles)
+{
+    charge(cycles);
+    while (!stack_.empty() && stack_.back().sp <= sp)
+        stack_.pop_back();
+    node_ = stack_.empty() ? 0 : stack_.back().node;
+}
+
+void Call_profiler::sync(uint32_t cycles)
+{
+    charge(cycles);
+}
+
+void Call_profiler::restart(uint32_t cycles)
+{
+    stack_.clear();
+    node_ = 0;
+    started_ = true;
+    last_cycles_ = cycles;
+}
+
+void Call_profiler::charge(uint32_t cycles)
+{
+    // the processor's count wraps around, the difference doesn't
+    if (started_)
+        nodes_[node_].self += cycles - last_cycles_;
+    started_ = true;
+    last_cycles_ = cycles;
+}
+
+void Call_profiler::clear()
+{
+    for (Node &n : nodes_)
+        n.calls = n.self = 0;
+}
+
+std::vector<Call_profiler::Function> Call_profiler::functions() const
+{
+    std::vector<uint64_t> total(nodes_.size());
+    for (size_t i = nodes_.size(); i-- > 0;)
+    {
+        total[i] += nodes_[i].self;
+        if (i)
+            total[nodes_[i].parent] += total[i];
+    }
+    std::map<uint32_t, Function> functions;
+    for (size_t i = 1; i < nodes_.size(); ++i)
+    {
+        const Node &n {nodes_[i]};
+        Function &f {functions[n.key]};
+        f.bank = static_cast<uint16_t>(n.key >> 16);
+        f.adr = n.key & 0xffff;
+        f.calls += n.calls;
+        f.self_cycles += n.self;
+        // a recursive call's cycles are already in the total of its outermost call
+        bool recursive {false};
+        for (uint32_t p = n.parent; p && !recursive; p = nodes_[p].parent)
+            recursive = nodes_[p].key == n.key;
+        if (!recursive)
+            f.total_cycles += total[i];
+    }
+    std::vector<Function> out;
+    for (const auto &[key, f] : functions)
+        out.push_back(f);
+    std::sort(out.begin(), out.end(), [](const Function &a, const Function &b) {
+        return a.self_cycles > b.self_cycles;
+    });
+    return out;
+}
+
+void Call_profiler::write_collapsed(std::ostream &os) const
+{
+    // the stack of a node is its parent's stack followed by its own frame
+    std::vector<std::string> stacks(nodes_.size());
+    stacks[0] = "[root]";
+    for (size_t i = 1; i < nodes_.size(); ++i)
+    {
+        std::ostringstream frame;
+        frame << std::hex << std::setfill('0') << std::setw(2) << (nodes_[i].key >> 16) << ':'
+              << std::setw(4) << (nodes_[i].key & 0xffff);
+        stacks[i] = (nodes_[i].parent ? stacks[nodes_[i].parent] + ';' : std::string {})
+                  + frame.str();
+    }
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        if (nodes_[i].self)
+            os << stacks[i] << ' ' << nodes_[i].self << '\n';
+    }
+}
+
+}
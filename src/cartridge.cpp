@@ -13,13 +13,38 @@ namespace qtboy
 {	
 
 Cartridge::Cartridge(std::istream &is)
-	: rom_ {is}
+    : Cartridge(Rom {is})
+{}
+
+Cartridge::Cartridge(Rom rom)
+    : rom_ {std::move(rom)}
 {
 	init_mbc();
     init_info();
     init_ram();
 }
 
+Cartridge::Cartridge(const Cartridge &other)
+    : rom_ {other.rom_},
+      ram_ {other.ram_},
+      // the MBC holds pointers to the ROM and RAM, so it's rebound to ours
+      mbc_ {other.mbc_ ? other.mbc_->clone(&rom_, &ram_) : nullptr},
+      title_ {other.title_},
+      has_battery_ {other.has_battery_}
+{}
+
+Cartridge &Cartridge::operator=(const Cartridge &other)
+{
+    if (this == &other)
+        return *this;
+    rom_ = other.rom_;
+    ram_ = other.ram_; // reuses our RAM banks when the sizes match
+    mbc_ = other.mbc_ ? other.mbc_->clone(&rom_, &ram_) : nullptr;
+    title_ = other.title_;
+    has_battery_ = other.has_battery_;
+    return *this;
+}
+
 void Cartridge::init_mbc()
 {
 	switch (rom_.read(0, 0x147))
@@ -150,11 +175,24 @@ std::unordered_map<std::string, Memory_range> Cartridge::dump() const
         out["RAMX"] = {"RAMX", std::vector<uint8_t>(sizeof(External_ram::Bank))};
     }
     out["ROM0"] = {"ROM0", rom_.dump(0)};
-    uint8_t rom_bank = mbc_ ? mbc_->rom_bank() : 1;
+    const uint16_t rom_bank {this->rom_bank()};
     out["ROMX"] = {"ROM" + std::to_string(rom_bank), rom_.dump(rom_bank)};
     return out;
 }
 
+uint8_t Cartridge::dump_byte(uint16_t adr) const
+{
+    if (adr < 0x8000)
+    {
+        const uint16_t bank {adr < 0x4000 ? uint16_t {0} : rom_bank()};
+        return rom_.read(bank, adr & (Rom::Bank_size - 1));
+    }
+    const std::size_t i {ram_bank() * External_ram::BANK_SIZE + (adr - 0xa000u)};
+    if (!ram_ || i >= ram_->size())
+        return 0;
+    return ram_->read(ram_bank(), static_cast<uint16_t>(adr - 0xa000));
+}
+
 std::vector<uint8_t> Cartridge::dump_rom() const
 {
     return rom_.dump();
@@ -171,6 +209,16 @@ std::vector<uint8_t> Cartridge::dump_ram() const
         return ram_->dump();
 }
 	
+uint16_t Cartridge::rom_bank() const
+{
+    return mbc_ ? mbc_->rom_bank() : 1;
+}
+
+uint8_t Cartridge::ram_bank() const
+{
+    return mbc_ ? mbc_->ram_bank() : 0;
+}
+
 bool Cartridge::is_cgb() const
 {
 	return rom_.read(0, 0x143) & 0x80; // upper bit
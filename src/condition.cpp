@@ -0,0 +1,321 @@
+#include "condition.hpp"
+#include "processor.hpp"
+#include "memory.hpp"
+
+#include <array>
+#include <cctype>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+// Maximum depth of the evaluation stack, checked at compile time.
+static constexpr std::size_t MAX_STACK {32};
+
+// Recursive descent parser emitting the bytecode of each operand right after its operands,
+// so the output is the expression in postfix order.
+class Condition::Parser
+{
+    public:
+    Parser(const std::string &source, Condition &out)
+        : src_ {source}, out_ {out}
+    {}
+
+    void parse()
+    {
+        expression(0);
+        skip_space();
+        if (pos_ != src_.size())
+            error("unexpected '" + std::string(1, src_[pos_]) + "'");
+    }
+
+    private:
+    struct Binary
+    {
+        const char *token;
+        Op op;
+        int level;
+    };
+
+    // longer tokens first so "<=" isn't read as "<"
+    static constexpr std::array<Binary, 18> binaries
+    {{
+        {"||", Op::Logical_or, 0}, {"&&", Op::Logical_and, 1},
+        {"==", Op::Equal, 5}, {"!=", Op::Not_equal, 5},
+        {"<=", Op::Less_equal, 6}, {">=", Op::Greater_equal, 6},
+        {"<<", Op::Shift_left, 7}, {">>", Op::Shift_right, 7},
+        {"|", Op::Or, 2}, {"^", Op::Xor, 3}, {"&", Op::And, 4},
+        {"<", Op::Less, 6}, {">", Op::Greater, 6},
+        {"+", Op::Add, 8}, {"-", Op::Subtract, 8},
+        {"*", Op::Multiply, 9}, {"/", Op::Divide, 9}, {"%", Op::Modulo, 9},
+    }};
+    static constexpr int LEVELS {10};
+
+    // Parse operators of at least the given precedence level.
+    void expression(int level)
+    {
+        if (level == LEVELS)
+        {
+            unary();
+            return;
+        }
+        expression(level + 1);
+        for (;;)
+        {
+            const Binary *b {peek_binary()};
+            if (!b || b->level != level)
+                return;
+            pos_ += std::char_traits<char>::length(b->token);
+            expression(level + 1);
+            emit(b->op, 0, -1);
+        }
+    }
+
+    void unary()
+    {
+        skip_space();
+        if (accept('!'))
+        {
+            unary();
+            emit(Op::Not, 0, 0);
+        }
+        else if (accept('~'))
+        {
+            unary();
+            emit(Op::Complement, 0, 0);
+        }
+        else if (accept('-'))
+        {
+            unary();
+            emit(Op::Negate, 0, 0);
+        }
+        else
+        {
+            primary();
+        }
+    }
+
+    void primary()
+    {
+        skip_space();
+        if (accept('('))
+        {
+            expression(0);
+            expect(')');
+        }
+        else if (accept('['))
+        {
+            expression(0);
+            expect(']');
+            emit(Op::Load, 0, 0);
+        }
+        else if (pos_ < src_.size() && (std::isdigit(static_cast<unsigned char>(src_[pos_]))
+                                        || src_[pos_] == '$'))
+        {
+            emit(Op::Push, number(), 1);
+        }
+        else if (pos_ < src_.size() && std::isalpha(static_cast<unsigned char>(src_[pos_])))
+        {
+            emit(Op::Register, static_cast<int32_t>(operand()), 1);
+        }
+        else
+        {
+            error(pos_ < src_.size() ? "unexpected '" + std::string(1, src_[pos_]) + "'"
+                                     : "unexpected end of condition");
+        }
+    }
+
+    int32_t number()
+    {
+        int base {10};
+        if (accept('$'))
+            base = 16;
+        else if (src_.compare(pos_, 2, "0x") == 0 || src_.compare(pos_, 2, "0X") == 0)
+            base = 16, pos_ += 2;
+        else if (src_.compare(pos_, 2, "0b") == 0 || src_.compare(pos_, 2, "0B") == 0)
+            base = 2, pos_ += 2;
+        const std::size_t start {pos_};
+        int64_t n {0};
+        for (; pos_ < src_.size() && std::isxdigit(static_cast<unsigned char>(src_[pos_]));
+             ++pos_)
+        {
+            const char c {static_cast<char>(std::tolower(static_cast<unsigned char>(src_[pos_])))};
+            const int digit {c <= '9' ? c - '0' : c - 'a' + 10};
+            if (digit >= base)
+                error("bad digit in number");
+            n = n * base + digit;
+            if (n > 0xffffffff)
+                error("number too large");
+        }
+        if (pos_ == start)
+            error("expected digits");
+        return static_cast<int32_t>(n);
+    }
+
+    Operand operand()
+    {
+        static const std::array<const char *, 21> names
+        {{
+            "A", "F", "B", "C", "D", "E", "H", "L", "AF", "BC", "DE", "HL", "SP", "PC",
+            "ZF", "NF", "HF", "CF", "IME", "LY", "BANK",
+        }};
+        const std::size_t start {pos_};
+        std::string name;
+        for (; pos_ < src_.size() && std::isalnum(static_cast<unsigned char>(src_[pos_])); ++pos_)
+            name += static_cast<char>(std::toupper(static_cast<unsigned char>(src_[pos_])));
+        for (std::size_t i {0}; i < names.size(); ++i)
+        {
+            if (name == names[i])
+                return static_cast<Operand>(i);
+        }
+        pos_ = start;
+        error("unknown name '" + name + "'");
+    }
+
+    const Binary *peek_binary()
+    {
+        skip_space();
+        for (const Binary &b : binaries)
+        {
+            if (src_.compare(pos_, std::char_traits<char>::length(b.token), b.token) == 0)
+                return &b;
+        }
+        return nullptr;
+    }
+
+    void emit(Op op, int32_t value, int stack_change)
+    {
+        out_.code_.push_back({op, value});
+        depth_ += stack_change;
+        if (static_cast<std::size_t>(depth_) > MAX_STACK)
+            error("condition nested too deeply");
+        if (static_cast<std::size_t>(depth_) > out_.stack_size_)
+            out_.stack_size_ = static_cast<std::size_t>(depth_);
+    }
+
+    bool accept(char c)
+    {
+        skip_space();
+        if (pos_ < src_.size() && src_[pos_] == c)
+        {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            error(std::string("expected '") + c + "'");
+    }
+
+    void skip_space()
+    {
+        while (pos_ < src_.size() && std::isspace(static_cast<unsigned char>(src_[pos_])))
+            ++pos_;
+    }
+
+    [[noreturn]] void error(const std::string &what) const
+    {
+        throw std::runtime_error {"Condition: " + what + " at column " + std::to_string(pos_ + 1)
+                                  + " of \"" + src_ + "\""};
+    }
+
+    const std::string &src_;
+    Condition &out_;
+    std::size_t pos_ {0};
+    int depth_ {0};
+};
+
+Condition::Condition(const std::string &source)
+    : source_ {source}
+{
+    // a blank source is the empty condition
+    if (source_.find_first_not_of(" \t\r\n") != std::string::npos)
+        Parser {source_, *this}.parse();
+}
+
+bool Condition::operator()(const Processor &cpu, const Memory &memory) const
+{
+    if (code_.empty())
+        return true;
+    std::array<int32_t, MAX_STACK> stack;
+    std::size_t top {0}; // one past the top of stack
+    for (const Instruction &i : code_)
+    {
+        switch (i.op)
+        {
+            case Op::Push: stack[top++] = i.value; continue;
+            case Op::Register:
+            {
+                int32_t v {0};
+                switch (static_cast<Operand>(i.value))
+                {
+                    case Operand::A: v = cpu.af() >> 8; break;
+                    case Operand::F: v = cpu.af() & 0xff; break;
+                    case Operand::B: v = cpu.bc() >> 8; break;
+                    case Operand::C: v = cpu.bc() & 0xff; break;
+                    case Operand::D: v = cpu.de() >> 8; break;
+                    case Operand::E: v = cpu.de() & 0xff; break;
+                    case Operand::H: v = cpu.hl() >> 8; break;
+                    case Operand::L: v = cpu.hl() & 0xff; break;
+                    case Operand::AF: v = cpu.af(); break;
+                    case Operand::BC: v = cpu.bc(); break;
+                    case Operand::DE: v = cpu.de(); break;
+                    case Operand::HL: v = cpu.hl(); break;
+                    case Operand::SP: v = cpu.sp(); break;
+                    case Operand::PC: v = cpu.pc(); break;
+                    case Operand::ZF: v = cpu.af() >> 7 & 1; break;
+                    case Operand::NF: v = cpu.af() >> 6 & 1; break;
+                    case Operand::HF: v = cpu.af() >> 5 & 1; break;
+                    case Operand::CF: v = cpu.af() >> 4 & 1; break;
+                    case Operand::IME: v = cpu.ime(); break;
+                    case Operand::LY: v = memory.read(0xff44); break;
+                    case Operand::BANK: v = memory.bank(cpu.pc()); break;
+                }
+                stack[top++] = v;
+                continue;
+            }
+            case Op::Load:
+                stack[top - 1] = memory.read(static_cast<uint16_t>(stack[top - 1]));
+                continue;
+            case Op::Not: stack[top - 1] = !stack[top - 1]; continue;
+            case Op::Complement: stack[top - 1] = ~stack[top - 1]; continue;
+            case Op::Negate:
+                stack[top - 1] = static_cast<int32_t>(0u - static_cast<uint32_t>(stack[top - 1]));
+                continue;
+            default:
+                break;
+        }
+        // binary operators
+        const int32_t b {stack[--top]};
+        int32_t &a {stack[top - 1]};
+        const uint32_t ua {static_cast<uint32_t>(a)}, ub {static_cast<uint32_t>(b)};
+        switch (i.op)
+        {
+            case Op::Multiply: a = static_cast<int32_t>(ua * ub); break;
+            case Op::Divide: a = b && !(a == INT32_MIN && b == -1) ? a / b : 0; break;
+            case Op::Modulo: a = b && !(a == INT32_MIN && b == -1) ? a % b : 0; break;
+            case Op::Add: a = static_cast<int32_t>(ua + ub); break;
+            case Op::Subtract: a = static_cast<int32_t>(ua - ub); break;
+            case Op::Shift_left: a = static_cast<int32_t>(ua << (ub & 31)); break;
+            case Op::Shift_right: a = static_cast<int32_t>(ua >> (ub & 31)); break;
+            case Op::Less: a = a < b; break;
+            case Op::Less_equal: a = a <= b; break;
+            case Op::Greater: a = a > b; break;
+            case Op::Greater_equal: a = a >= b; break;
+            case Op::Equal: a = a == b; break;
+            case Op::Not_equal: a = a != b; break;
+            case Op::And: a = a & b; break;
+            case Op::Xor: a = a ^ b; break;
+            case Op::Or: a = a | b; break;
+            case Op::Logical_and: a = a && b; break;
+            case Op::Logical_or: a = a || b; break;
+            default: break;
+        }
+    }
+    return stack[0] != 0;
+}
+
+}
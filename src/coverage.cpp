@@ -0,0 +1,165 @@
+#include "coverage.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+static uint16_t bank_mask(std::size_t rom_banks)
+{
+    uint16_t mask {1};
+    while (mask + 1u < rom_banks)
+        mask = mask << 1 | 1;
+    return mask;
+}
+
+Coverage::Coverage(std::size_t rom_banks)
+    : bank_mask_ {bank_mask(rom_banks)},
+      code_((0x10000 + (bank_mask_ + 1u) * 0x4000u) / 64, 0),
+      data_(code_.size(), 0)
+{}
+
+Coverage::Kind Coverage::kind(uint16_t bank, uint16_t adr) const
+{
+    const uint32_t i {index(bank, adr)};
+    return static_cast<Kind>(test(code_, i) | test(data_, i) << 1);
+}
+
+std::size_t Coverage::count(Kind k) const
+{
+    std::size_t n {0};
+    for (std::size_t w {0}; w < code_.size(); ++w)
+    {
+        const uint64_t code {k & Code ? code_[w] : ~code_[w]};
+        const uint64_t data {k & Data ? data_[w] : ~data_[w]};
+        n += std::bitset<64>(code & data).count();
+    }
+    return n;
+}
+
+std::vector<Coverage::Run> Coverage::runs() const
+{
+    std::vector<Run> out;
+    const uint32_t bits {static_cast<uint32_t>(code_.size() * 64)};
+    for (uint32_t i {0}; i < bits;)
+    {
+        // skip unused words whole
+        if (!(i & 63) && !code_[i >> 6] && !data_[i >> 6])
+        {
+            i += 64;
+            continue;
+        }
+        const auto kind_at = [this](uint32_t j) {
+            return static_cast<Kind>(test(code_, j) | test(data_, j) << 1);
+        };
+        const Kind k {kind_at(i)};
+        if (k == Unused)
+        {
+            ++i;
+            continue;
+        }
+        // runs end at the end of a bank
+        const uint32_t bank_end {i < 0x10000 ? (i < 0x4000 ? 0x4000u : 0x10000u)
+                                             : i - (i - 0x10000) % 0x4000 + 0x4000};
+        uint32_t j {i + 1};
+        while (j < bank_end && kind_at(j) == k)
+            ++j;
+        if (i < 0x10000)
+            out.push_back({0, static_cast<uint16_t>(i), static_cast<uint16_t>(j - 1), k});
+        else
+            out.push_back({static_cast<uint16_t>((i - 0x10000) / 0x4000),
+                           static_cast<uint16_t>(0x4000 + (i - 0x10000) % 0x4000),
+                           static_cast<uint16_t>(0x4000 + (j - 1 - 0x10000) % 0x4000), k});
+        i = j;
+    }
+    return out;
+}
+
+void Coverage::clear()
+{
+    std::fill(code_.begin(), code_.end(), 0);
+    std::fill(data_.begin(), data_.end(), 0);
+}
+
+void Coverage::write_csv(std::ostream &os) const
+{
+    static const std::array<const char *, 4> kinds {{"", "code", "data", "both"}};
+    os << "kind,bank,first,last,bytes\n" << std::hex << std::setfill('0');
+    for (const Run &r : runs())
+        os << kinds[r.kind] << ',' << std::setw(2) << r.bank << ',' << std::setw(4) << r.first
+           << ',' << std::setw(4) << r.last << ',' << std::dec << r.last - r.first + 1
+           << std::hex << '\n';
+    os << std::dec << std::setfill(' ');
+}
+
+void Coverage::merge(const Coverage &other)
+{
+    if (other.code_.size() != code_.size())
+        throw std::runtime_error {"Coverage: can't merge a map for a ROM of a different size"};
+    for (std::size_t w {0}; w < code_.size(); ++w)
+    {
+        code_[w] |= other.code_[w];
+        data_[w] |= other.data_[w];
+    }
+}
+
+void Coverage::save(const std::string &path) const
+{
+    std::ofstream out {path, std::ios::binary};
+    save(out);
+    if (!out)
+        throw std::runtime_error {"Coverage: could not write coverage file " + path};
+}
+
+void Coverage::save(std::ostream &os) const
+{
+    const Header h {MAGIC, VERSION, static_cast<uint32_t>(code_.size())};
+    os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    for (const std::vector<uint64_t> *bits : {&code_, &data_})
+        os.write(reinterpret_cast<const char *>(bits->data()),
+                 static_cast<std::streamsize>(bits->size() * sizeof(uint64_t)));
+}
+
+void Coverage::load(const std::string &path)
+{
+    std::ifstream in {path, std::ios::binary};
+    if (!in)
+        throw std::runtime_error {"Coverage: could not open coverage file " + path};
+    try
+    {
+        load(in);
+    }
+    catch (const std::runtime_error &e)
+    {
+        throw std::runtime_error {std::string {e.what()} + ": " + path};
+    }
+}
+
+void Coverage::load(std::istream &is)
+{
+    Header h {};
+    is.read(reinterpret_cast<char *>(&h), sizeof(h));
+    if (!is || h.magic != MAGIC)
+        throw std::runtime_error {"Coverage: not a coverage file"};
+    if (h.version != VERSION)
+        throw std::runtime_error {"Coverage: unsupported coverage file version"};
+    if (h.words != code_.size())
+        throw std::runtime_error {"Coverage: coverage file is for a ROM of a different size"};
+    // read both maps before merging, so a truncated file changes nothing
+    std::vector<uint64_t> bits(code_.size() * 2);
+    is.read(reinterpret_cast<char *>(bits.data()),
+            static_cast<std::streamsize>(bits.size() * sizeof(uint64_t)));
+    if (!is)
+        throw std::runtime_error {"Coverage: coverage file is truncated"};
+    for (std::size_t w {0}; w < code_.size(); ++w)
+    {
+        code_[w] |= bits[w];
+        data_[w] |= bits[code_.size() + w];
+    }
+}
+
+}
@@ -0,0 +1,228 @@
+#include "cpu_trace.hpp"
+#include "disassembler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h> // open()
+#include <sys/mman.h> // mmap()
+#include <unistd.h> // ftruncate(), close()
+#endif
+
+namespace qtboy
+{
+
+// Create (or truncate) the file at path with the given size and map it read-write.
+// Returns nullptr on failure.
+static void *map_new_file(const std::string &path, std::size_t size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                              nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    const uint64_t len {size};
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(len >> 32),
+                                        static_cast<DWORD>(len & 0xffffffff), nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+    // the view keeps the mapping alive after its handle is closed
+    void *view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+    CloseHandle(mapping);
+    return view;
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return nullptr;
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    void *base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return base == MAP_FAILED ? nullptr : base;
+#endif
+}
+
+static Cpu_trace::Header new_header(std::size_t capacity)
+{
+    return {Cpu_trace::MAGIC, Cpu_trace::VERSION, sizeof(Cpu_trace::Record), capacity, 0};
+}
+
+Cpu_trace::Cpu_trace(std::size_t capacity)
+    : capacity_ {capacity},
+      header_storage_ {std::make_unique<Header>(new_header(capacity))},
+      record_storage_(capacity)
+{
+    if (capacity == 0)
+        throw std::runtime_error {"Cpu_trace: capacity must be at least 1"};
+    header_ = header_storage_.get();
+    records_ = record_storage_.data();
+}
+
+Cpu_trace::Cpu_trace(const std::string &path, std::size_t capacity)
+    : capacity_ {capacity}
+{
+    if (capacity == 0)
+        throw std::runtime_error {"Cpu_trace: capacity must be at least 1"};
+    mapping_size_ = sizeof(Header) + capacity * sizeof(Record);
+    mapping_ = map_new_file(path, mapping_size_);
+    if (!mapping_)
+        throw std::runtime_error {"Cpu_trace: could not map trace file " + path};
+    header_ = static_cast<Header *>(mapping_);
+    *header_ = new_header(capacity);
+    records_ = reinterpret_cast<Record *>(header_ + 1);
+}
+
+Cpu_trace::~Cpu_trace()
+{
+    if (!mapping_)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+#else
+    ::munmap(mapping_, mapping_size_);
+#endif
+}
+
+std::size_t Cpu_trace::size() const
+{
+    return static_cast<std::size_t>(std::min<uint64_t>(header_->written, capacity_));
+}
+
+const Cpu_trace::Record &Cpu_trace::operator[](std::size_t i) const
+{
+    // before wrapping next_ is the number of records, after it's the oldest
+    const std::size_t first {header_->written > capacity_ ? next_ : 0};
+    return records_[(first + i) % capacity_];
+}
+
+void Cpu_trace::clear()
+{
+    next_ = 0;
+    header_->written = 0;
+}
+
+void Cpu_trace::save(const std::string &path) const
+{
+    std::ofstream out {path, std::ios::binary};
+    out.write(reinterpret_cast<const char *>(header_), sizeof(Header));
+    out.write(reinterpret_cast<const char *>(records_),
+              static_cast<std::streamsize>(capacity_ * sizeof(Record)));
+    if (!out)
+        throw std::runtime_error {"Cpu_trace: could not write trace file " + path};
+}
+
+std::vector<Cpu_trace::Record> Cpu_trace::load(const std::string &path)
+{
+    std::ifstream in {path, std::ios::binary};
+    if (!in)
+        throw std::runtime_error {"Cpu_trace: could not open trace file " + path};
+    Header h {};
+    in.read(reinterpret_cast<char *>(&h), sizeof(h));
+    if (!in || h.magic != MAGIC)
+        throw std::runtime_error {"Cpu_trace: " + path + " is not a trace file"};
+    if (h.version != VERSION || h.record_size != sizeof(Record) || h.capacity == 0)
+        throw std::runtime_error {"Cpu_trace: unsupported trace file " + path};
+    std::vector<Record> ring(static_cast<std::size_t>(h.capacity));
+    in.read(reinterpret_cast<char *>(ring.data()),
+            static_cast<std::streamsize>(ring.size() * sizeof(Record)));
+    if (!in)
+        throw std::runtime_error {"Cpu_trace: trace file " + path + " is truncated"};
+    if (h.written <= h.capacity)
+    {
+        ring.resize(static_cast<std::size_t>(h.written));
+        return ring;
+    }
+    // the ring has wrapped, rotate the oldest record to the front
+    std::rotate(ring.begin(), ring.begin() + static_cast<std::ptrdiff_t>(h.written % h.capacity),
+                ring.end());
+    return ring;
+}
+
+// Name of the memory region at adr with bank mapped there, as in Memory::dump_mapped().
+static std::string region_name(uint16_t adr, uint16_t bank)
+{
+    if (adr < 0x8000)
+        return "ROM" + std::to_string(bank);
+    if (adr < 0xa000)
+        return "VRM" + std::to_string(bank);
+    if (adr < 0xc000)
+        return "RAM" + std::to_string(bank);
+    if (adr < 0xe000)
+        return "WRM" + std::to_string(bank);
+    if (adr < 0xfe00)
+        return "ECHO";
+    if (adr < 0xfea0)
+        return "OAM";
+    if (adr < 0xff00)
+        return "XXXX";
+    if (adr < 0xff80)
+        return "IO";
+    return "HRAM";
+}
+
+std::string Cpu_trace::format(const Record &r)
+{
+    std::ostringstream out {};
+    Assembly as {Disassembler::disassemble_op(r.ops, r.pc)};
+    uint8_t a = static_cast<uint8_t>(r.af >> 8);
+    uint8_t f = static_cast<uint8_t>(r.af & 0xff);
+    uint8_t b = static_cast<uint8_t>(r.bc >> 8);
+    uint8_t c = static_cast<uint8_t>(r.bc & 0xff);
+    uint8_t d = static_cast<uint8_t>(r.de >> 8);
+    uint8_t e = static_cast<uint8_t>(r.de & 0xff);
+    uint8_t h = static_cast<uint8_t>(r.hl >> 8);
+    uint8_t l = static_cast<uint8_t>(r.hl & 0xff);
+    static const std::array<std::string, 16> flag_char // flag register in character format
+    {{
+        "----", "---C", "--H-", "--HC",
+        "-N--", "-N-C", "-NH-", "-NHC",
+        "Z---", "Z--C", "Z-H-", "Z-HC",
+        "ZN--", "ZN-C", "ZNH-", "ZNHC",
+    }};
+
+    // register values
+    out << std::uppercase << std::right << std::hex << std::setfill('0')
+        << "A:" << std::setw(2) << static_cast<int>(a) << ' '
+        << "F:" << flag_char[(f >> 4)] << ' '
+        << "BC:" << std::setw(2) << static_cast<int>(b) << std::setw(2) << static_cast<int>(c) << ' ' << std::nouppercase
+        << "DE:" << std::setw(2) << static_cast<int>(d) << std::setw(2) << static_cast<int>(e) << ' '
+        << "HL:" << std::setw(2) << static_cast<int>(h) << std::setw(2) << static_cast<int>(l) << ' '
+        << "SP:" << std::setw(4) << r.sp << ' '
+        << "PC:" << std::setw(4) << r.pc << ' '
+        << "LY:" << std::setw(2) << static_cast<int>(r.ly) << ' '
+        << "IME:" << static_cast<int>(r.ime) << ' '
+        << "(cy: " << std::dec << r.cycles << ") ";
+
+    // instruction being executed
+    out << std::uppercase << region_name(r.pc, r.bank)
+        << std::nouppercase << std::right << std::setfill('0') << std::hex
+        << std::setw(4) << r.pc << ": "; // PC
+    std::ostringstream ops {}; // so we can set fixed width for variable
+                               // number of ops
+    for (uint8_t x : as.ops)
+        ops << std::nouppercase << std::setfill('0') << std::hex << std::setw(2)
+            << static_cast<int>(x) << ' ';
+    std::string ins {as.code};
+    for (auto &ch : ins)
+        ch = static_cast<char>(std::tolower(ch));
+    out << std::left << std::setfill(' ') << std::setw(10) << ops.str() // bytes
+        << std::setw(20) << ins; // instruction
+
+    return out.str();
+}
+
+}
@@ -3,23 +3,27 @@
 #include "system.hpp"
 #include "exception.hpp"
 
+#include <algorithm>
+#include <array>
 #include <sstream>
 #include <iomanip>
-#include <cctype>
+#include <tuple>
 
 namespace qtboy
 {
 
 Debugger::Debugger(std::shared_ptr<Gameboy> g)
-    : system_ {std::move(g)}
+    : system_ {std::move(g)},
+      disassembly_ {[this](uint16_t adr){ return system_->memory_read(adr); },
+                    [this](uint16_t adr){ return system_->mapped_bank(adr); }}
 {
     if (!system_)
         throw std::runtime_error {"Could not construct Debugger from nullptr"};
     // use update() as the debug_callback for Gameboy to be called after every CPU instruction
     system_->set_cpu_debug_callback([this]{ return cpu_callback(); });
-    system_->set_memory_debug_callback([this](uint8_t b, uint16_t adr)
-    {
-        return memory_callback(b, adr);
+    // code decoded in RAM is dropped when it's overwritten
+    system_->set_memory_debug_callback([this](uint8_t, uint16_t adr){
+        disassembly_.invalidate(adr);
     });
     // memory_map_ = system_->dump_mapped_memory();
 }
@@ -37,51 +41,82 @@ Debugger::~Debugger()
 
 void Debugger::set_debug_mode(bool b)
 {
+    // writes weren't seen outside debug mode
+    if (b && !debug_mode_)
+        disassembly_.invalidate_ram();
+    debug_mode_ = b;
     system_->set_debug_mode(b);
 }
 
-// CPU callback handles logging and breakpoints.
+// CPU callback handles logging. Breakpoints are checked by the system itself.
 bool Debugger::cpu_callback()
 {
     ++steps_;
     if (logging_)
         write_log();
-    if (breaking_ && at_breakpoint())
-        // return true to request a CPU break
-        return true;
     return false;
 }
 
-void Debugger::memory_callback(uint8_t b, uint16_t adr)
-{
-
-}
-
 void Debugger::run_until_break()
 {
-    breaking_ = true;
+    system_->enable_breakpoints(true);
     system_->resume();
 }
 
 void Debugger::run_no_break()
 {
-    breaking_ = false;
+    system_->enable_breakpoints(false);
     system_->resume();
 }
 
-void Debugger::add_breakpoint(uint16_t adr)
+void Debugger::set_reverse_debugging(bool b)
+{
+    system_->set_history(b);
+}
+
+// Memory is restored and replayed without the memory callback, so code decoded in RAM may
+// be stale after going back.
+bool Debugger::step_back()
+{
+    disassembly_.invalidate_ram();
+    return system_->step_back();
+}
+
+bool Debugger::reverse_continue()
+{
+    disassembly_.invalidate_ram();
+    return system_->reverse_continue();
+}
+
+void Debugger::add_breakpoint(uint16_t adr, int bank, const std::string &condition)
+{
+    system_->add_breakpoint(adr, bank, condition);
+}
+
+void Debugger::delete_breakpoint(uint16_t adr, int bank)
+{
+    system_->delete_breakpoint(adr, bank);
+}
+
+std::vector<Breakpoints::Breakpoint> Debugger::breakpoints() const
 {
-    breaks_[adr] = true;
+    return system_->breakpoints();
 }
 
-void Debugger::delete_breakpoint(uint16_t adr)
+int Debugger::add_watchpoint(uint16_t first, uint16_t last, uint8_t access, int bank,
+                             const std::string &condition)
 {
-    breaks_[adr] = false;
+    return system_->add_watchpoint(first, last, access, bank, condition);
 }
 
-const std::unordered_map<uint16_t, bool> &Debugger::breakpoints() const
+void Debugger::delete_watchpoint(int id)
 {
-    return breaks_;
+    system_->delete_watchpoint(id);
+}
+
+std::vector<Watchpoints::Watchpoint> Debugger::watchpoints() const
+{
+    return system_->watchpoints();
 }
 
 void Debugger::set_logging(bool b)
@@ -117,69 +152,82 @@ void Debugger::reset()
 {
     system_->reset();
     steps_ = 0;
+    disassembly_.invalidate_ram();
+    disassembled_ = 0;
 }
 
 
 std::string Debugger::log()
 {
-    std::ostringstream out {};
-    Cpu_dump dump {system_->dump_cpu()};
-    Assembly as {disassembler_.disassemble_op(dump.next_ops, dump.pc)};
-    uint8_t a = dump.af >> 8;
-    uint8_t f = dump.af & 0xff;
-    uint8_t b = dump.bc >> 8;
-    uint8_t c = dump.bc & 0xff;
-    uint8_t d = dump.de >> 8;
-    uint8_t e = dump.de & 0xff;
-    uint8_t h = dump.hl >> 8;
-    uint8_t l = dump.hl & 0xff;
-    uint8_t ly = system_->memory_read(0xff44);
-    std::array<std::string, 24> flag_char // flag register in character format
-    {{
-        "----", "---C", "--H-", "--HC",
-        "-N--", "-N-C", "-NH-", "-NHC",
-        "Z---", "Z--C", "Z-H-", "Z-HC",
-        "ZN--", "ZN-C", "ZNH-", "ZNHC",
-    }};
+    return Cpu_trace::format(system_->trace_record());
+}
 
-    // begin output
+std::vector<Disassembly_cache::Line> Debugger::disassemble(uint16_t first, uint16_t last) const
+{
+    update_disassembly();
+    return disassembly_.lines(first, last);
+}
 
-    // register values
-    out << std::uppercase << std::right << std::hex << std::setfill('0')
-        << "A:" << std::setw(2) << static_cast<int>(a) << ' '
-        << "F:" << flag_char[(f >> 4)] << ' '
-        << "BC:" << std::setw(2) << static_cast<int>(b) << std::setw(2) << static_cast<int>(c) << ' ' << std::nouppercase
-        << "DE:" << std::setw(2) << static_cast<int>(d) << std::setw(2) << static_cast<int>(e) << ' '
-        << "HL:" << std::setw(2) << static_cast<int>(h) << std::setw(2) << static_cast<int>(l) << ' '
-        << "SP:" << std::setw(4) << dump.sp << ' '
-        << "PC:" << std::setw(4) << dump.pc << ' '
-        << "LY:" << std::setw(2) << static_cast<int>(ly) << ' '
-        << "IME:" << static_cast<int>(dump.ime) << ' '
-        << "(cy: " << std::dec << dump.cycles << ") ";
+std::vector<Disassembly_cache::Line> Debugger::disassemble_rom_bank(uint16_t bank) const
+{
+    update_disassembly();
+    return disassembly_.rom_lines(bank);
+}
 
+void Debugger::update_disassembly() const
+{
+    if (const Rom *rom {system_->rom()})
+        disassembly_.set_rom(*rom);
+    if (!debug_mode_)
+        disassembly_.invalidate_ram();
+    // entry points from the instructions executed since the last update
+    const Flight_recorder &recorder {system_->flight_recorder()};
+    if (recorder.count() < disassembled_) // cleared by a reset
+        disassembled_ = 0;
+    recorder.for_each_last(recorder.count() - disassembled_,
+                           [this](const Flight_recorder::Instruction &in){
+        if (in.pc < 0x8000)
+            disassembly_.add_entry(in.pc, in.bank);
+        else
+            disassembly_.add_entry(in.pc);
+    });
+    disassembled_ = recorder.count();
+    disassembly_.add_entry(system_->dump_cpu().pc);
+}
 
-    // instruction being executed
-    out << std::uppercase << memory_map_["ROMX"].name
-        << std::nouppercase << std::right << std::setfill('0') << std::hex
-        << std::setw(4) << dump.pc << ": "; // PC
-    std::ostringstream ops {}; // so we can set fixed width for variable
-                               // number of ops
-    for (uint8_t x : as.ops)
-        ops << std::nouppercase << std::setfill('0') << std::hex << std::setw(2)
-            << static_cast<int>(x) << ' ';
-    std::string ins {as.code};
-    for (auto &c : ins)
-        c = static_cast<char>(std::tolower(c));
-    out << std::left << std::setfill(' ') << std::setw(10) << ops.str() // bytes
-        << std::setw(20) << ins; // instruction
+Analysis &Debugger::analysis()
+{
+    const Rom *rom {system_->rom()};
+    if (!rom)
+        throw std::runtime_error {"Debugger: no ROM loaded"};
+    if (!analysis_ || !analysis_->matches(*rom))
+        analysis_ = std::make_unique<Analysis>(*rom);
+    return *analysis_;
+}
 
-    return out.str();
+void Debugger::save_analysis(const std::string &path)
+{
+    Analysis &a {analysis()};
+    update_disassembly();
+    a.set_entries(disassembly_.rom_entries());
+    if (const Coverage *c {system_->coverage()})
+        a.coverage().merge(*c);
+    a.save(path);
 }
 
-std::vector<Assembly> Debugger::disassemble() const
+void Debugger::load_analysis(const std::string &path)
 {
-    const std::vector<uint8_t> &ops {dump_memory()};
-    return disassembler_.disassemble(ops);
+    Analysis &a {analysis()};
+    a.load(path);
+    update_disassembly();
+    for (const Disassembly_cache::Entry &e : a.entries())
+        disassembly_.add_entry(e.adr, e.bank);
+    // a run of executed bytes starts with an opcode, the operands follow it
+    for (const Coverage::Run &r : a.coverage().runs())
+    {
+        if (r.kind & Coverage::Code)
+            disassembly_.add_entry(r.first, r.bank);
+    }
 }
 
 void Debugger::update_memory_cache() const
@@ -274,84 +322,87 @@ std::vector<uint8_t> Debugger::dump_memory() const
 }
 
 
+// First and last address of the region of dump_mapped_memory() holding adr.
+static std::pair<uint16_t, uint16_t> memory_region(uint16_t adr)
+{
+    static constexpr std::array<uint16_t, 11> starts
+    {{
+        0x0000, 0x4000, 0x8000, 0xa000, 0xc000, 0xd000, 0xe000, 0xfe00, 0xfea0, 0xff00, 0xff80,
+    }};
+    const auto next {std::upper_bound(starts.begin(), starts.end(), adr)};
+    return {*(next - 1), next == starts.end() ? 0xffff : static_cast<uint16_t>(*next - 1)};
+}
+
 std::string Debugger::dump_formatted_memory(Dump_format d) const
 {
-    memory_map_ = system_->dump_mapped_memory();
-    std::ostringstream dump {};
-    std::ostringstream out {};
-    out << std::hex << std::setfill('0');
-    uint16_t adr = 0;
-    switch (d)
+    std::string out;
+    format_memory_rows(0, memory_rows(d), out, d);
+    return out;
+}
+
+std::size_t Debugger::memory_rows(Dump_format d)
+{
+    return d == Dump_format::Hex ? 0x10000 / 16 : 0x10000;
+}
+
+void Debugger::format_memory_rows(std::size_t first, std::size_t count, std::string &out,
+                                  Dump_format d) const
+{
+    out.clear();
+    const std::size_t rows {memory_rows(d)};
+    if (first >= rows)
+        return;
+    count = std::min(count, rows - first);
+    const std::size_t row_bytes {d == Dump_format::Hex ? 16u : 1u};
+    // the lowest address shown: Hex rows go up from 0000, Stack rows down from ffff
+    const uint16_t low = static_cast<uint16_t>(
+            d == Dump_format::Hex ? first * 16 : 0x10000 - first - count);
+    memory_window_.resize(count * row_bytes);
+    system_->dump_mapped_memory(low, memory_window_.size(), memory_window_.data());
+    static constexpr char digits[] {"0123456789abcdef"};
+    char line[96];
+    static const std::string ime {"IME"};
+    std::string name;
+    uint16_t name_first {1}, name_last {0}; // the region name is for, none yet
+    for (std::size_t r {0}; r < count; ++r)
     {
-        case Dump_format::Hex:
+        const std::size_t i {d == Dump_format::Hex ? r * 16 : count - 1 - r};
+        const uint16_t adr = static_cast<uint16_t>(low + i);
+        // row marker, the region name right aligned in 4 characters
+        if (adr < name_first || adr > name_last)
         {
-            for (const std::string &r : Memory_range_names)
-            {
-                const std::vector<uint8_t> &v {memory_map_[r].data};
-                // rows + data
-                for (size_t j {0}; j < v.size(); j += 16, adr += 16)
-                {
-                    // row marker
-                    out << std::setfill(' ') << std::setw(4)
-                        << memory_map_[r].name << ':'
-                        << std::setw(4) << std::setfill('0') << std::hex
-                        << adr << ' ';
-                    // line of 16 bytes
-                    std::string line;
-                    for (unsigned short k {0}; k < 16; ++k)
-                    {
-                        const uint8_t c {v[j+k]};
-                        if (c < 32 || c == 127) // non-printable ASCII
-                            line += '.';
-                        else
-                            line += static_cast<char>(c);
-                        out << std::setw(2) << std::setfill('0') << std::hex
-                            << static_cast<int>(c) << ' ';
-                    }
-                    out << line << '\n';
-                }
-            }
-        } break;
-        case Dump_format::Stack:
+            name = system_->mapped_region_name(adr);
+            std::tie(name_first, name_last) = memory_region(adr);
+        }
+        const std::string &label {d == Dump_format::Stack && adr == 0xffff ? ime : name};
+        char *p {line};
+        for (std::size_t k {label.size()}; k < 4; ++k)
+            *p++ = ' ';
+        p = std::copy(label.begin(), label.end(), p);
+        *p++ = ':';
+        for (int shift {12}; shift >= 0; shift -= 4)
+            *p++ = digits[adr >> shift & 0xf];
+        *p++ = ' ';
+        for (std::size_t k {0}; k < row_bytes; ++k)
+        {
+            const uint8_t c {memory_window_[i + k]};
+            *p++ = digits[c >> 4];
+            *p++ = digits[c & 0xf];
+            if (d == Dump_format::Hex)
+                *p++ = ' ';
+        }
+        // the bytes as text, non-printable ASCII as '.'
+        if (d == Dump_format::Hex)
         {
-            adr = 0xffff;
-            // iterate backwards through memory ranges (first entry is HRAM)
-            for (auto i_name {Memory_range_names.rbegin()};
-                 i_name < Memory_range_names.rend();
-                 ++i_name)
+            for (std::size_t k {0}; k < row_bytes; ++k)
             {
-                // get vector of bytes associated with this memory range
-                const std::vector<uint8_t> &v {memory_map_[*i_name].data};
-                // iterate backwards through memory (start with hi addresses)
-                for (auto i_byte = v.rbegin();
-                     i_byte < v.rend();
-                     ++i_byte, --adr)
-                {
-                    std::string label = (adr == 0xffff)
-                            ? "IME"
-                            : memory_map_[*i_name].name;
-                    out << std::setfill(' ') << std::setw(4)
-                        << label << ':'
-                        << std::setw(4) << std::setfill('0') << std::hex
-                        << adr << ' '
-                        << std::setw(2) << static_cast<int>(*i_byte)
-                        << '\n';
-                }
+                const uint8_t c {memory_window_[i + k]};
+                *p++ = c < 32 || c == 127 ? '.' : static_cast<char>(c);
             }
-        } break;
-    }
-    return out.str();
-}
-
-bool Debugger::at_breakpoint()
-{
-    uint16_t pc {system_->dump_cpu().pc};
-    if (breaks_[pc])
-    {
-        std::cout << "Reached breakpoint " << std::hex << pc;
-        return true;
+        }
+        *p++ = '\n';
+        out.append(line, static_cast<std::size_t>(p - line));
     }
-    return false;
 }
 
 }
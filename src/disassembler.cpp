@@ -3,10 +3,11 @@
 #include "exception.hpp"
 #include "debug_types.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <string>
-#include <iomanip>
-#include <iostream>
+#include <string_view>
 
 namespace qtboy
 {
@@ -17,77 +18,224 @@ Disassembler::Disassembler()
 
 std::string Disassembler::pretty_disassemble(const std::vector<uint8_t> &ops)
 {
-    uint8_t len {0};
-    std::ostringstream out {};
-    for (uint32_t pc {0}; pc < ops.size(); pc += len)
+    return pretty_disassemble(ops, nullptr, nullptr);
+}
+
+std::string Disassembler::pretty_disassemble(const std::vector<uint8_t> &rom,
+                                             const Execution_histogram &h)
+{
+    return pretty_disassemble(rom, &h, nullptr);
+}
+
+std::string Disassembler::pretty_disassemble(const std::vector<uint8_t> &rom, const Coverage &c)
+{
+    return pretty_disassemble(rom, nullptr, &c);
+}
+
+// Writers for the formatters below, each appends to out and returns the new end.
+
+static char *put(char *out, std::string_view s)
+{
+    for (const char c : s)
+        *out++ = c;
+    return out;
+}
+
+static constexpr char hex_digits[] {"0123456789ABCDEF"};
+
+// b as two upper case hex digits
+static char *put_hex2(char *out, uint8_t b)
+{
+    out[0] = hex_digits[b >> 4];
+    out[1] = hex_digits[b & 0xf];
+    return out + 2;
+}
+
+// x in hex, at least width digits
+static char *put_hex(char *out, size_t x, int width, bool upper_case = true)
+{
+    const char *digits {upper_case ? hex_digits : "0123456789abcdef"};
+    char reversed[2 * sizeof(size_t)];
+    int n {0};
+    do
     {
-        Instruction ins {instructions[ops[pc]]};
-        len = ins.length;
-        std::ostringstream bytes {};
-        for (uint8_t i {0}; i < ins.length; ++i) // opcodes
-            bytes << std::setfill('0') << ' ' << std::hex
-                  << std::setw(2) << static_cast<int>(ops[pc+i]);
-        const std::string operand1 {ins.operand1.empty() ? "" : ins.operand1};
-        const std::string operand2 {ins.operand2.empty() ? "" : ins.operand2};
-        out << std::setfill('0') << std::setw(4) << std::hex << std::right << pc; // address
-        out << std::setfill(' ') << std::setw(10) << std::left << bytes.str() // opcodes
-            << ' ' << std::setw(4) << ins.name; // instruction
-        if (!operand1.empty())
+        reversed[n++] = digits[x & 0xf];
+        x >>= 4;
+    } while (x);
+    for (; n < width; --width)
+        *out++ = '0';
+    while (n)
+        *out++ = reversed[--n];
+    return out;
+}
+
+// Text padded with spaces, so format() copies a fixed size and branches on nothing but
+// the kind of operand.
+struct Padded
+{
+    std::array<char, 16> text;
+    uint8_t length;
+};
+
+static constexpr Padded pad(std::string_view s, std::size_t min_length)
+{
+    Padded p {};
+    for (char &c : p.text)
+        c = ' ';
+    for (std::size_t i {0}; i < s.size() && i < p.text.size(); ++i)
+        p.text[i] = s[i];
+    p.length = static_cast<uint8_t>(std::max(std::min(s.size(), p.text.size()), min_length));
+    return p;
+}
+
+// mnemonics padded to at least 4 (LD, ADD, SBC, BIT), the CB prefixed ones after the others
+static constexpr std::array<Padded, 512> padded_names {[]{
+    std::array<Padded, 512> names {};
+    for (std::size_t i {0}; i < 256; ++i)
+    {
+        names[i] = pad(instructions[i].name, 4);
+        names[256 + i] = pad(cb_instructions[i].name, 4);
+    }
+    return names;
+}()};
+
+static constexpr std::array<Padded, operand_names.size()> padded_operands {[]{
+    std::array<Padded, operand_names.size()> operands {};
+    for (std::size_t i {0}; i < operands.size(); ++i)
+        operands[i] = pad(operand_names[i], 0);
+    return operands;
+}()};
+
+static char *put_name(char *out, Operand operand)
+{
+    const Padded &name {padded_operands[static_cast<std::size_t>(operand)]};
+    std::memcpy(out, name.text.data(), 8); // no operand name is longer
+    return out + name.length;
+}
+
+// operands standing for bytes of the instruction are filled in from ops, adr is the address
+// of the instruction (for relative jumps)
+static char *put_operand(char *out, const std::array<uint8_t, 3> &ops, Operand operand,
+                         size_t adr)
+{
+    if (!is_immediate(operand))
+        return put_name(out, operand);
+    switch (operand)
+    {
+        case Operand::A16: // 16-bit immediate
+        case Operand::D16:
+            *out++ = '$';
+            return put_hex2(put_hex2(out, ops[2]), ops[1]);
+        case Operand::R8: // 8-bit signed immediate (relative address)
         {
-            out << ' ' << operand1;
-            if (!operand2.empty())
-                out << ',' << operand2;
+            const size_t dest {adr + 2 + static_cast<size_t>(static_cast<int8_t>(ops[1]))};
+            *out++ = '$';
+            if (dest > 0xffff) // ROM offsets past the first 64 KB
+                return put_hex(out, dest, 4);
+            return put_hex2(put_hex2(out, static_cast<uint8_t>(dest >> 8)),
+                            static_cast<uint8_t>(dest));
         }
-        out << '\n';
+        case Operand::D8: // 8-bit unsigned immediate
+            *out++ = '$';
+            return put_hex2(out, ops[1]);
+        case Operand::A8_ind: // 8-bit unsigned indexing
+            out = put(out, "($ff");
+            out = put_hex2(out, ops[1]);
+            *out++ = ')';
+            return out;
+        case Operand::A16_ind: // 16-bit direct
+            out = put(out, "($");
+            out = put_hex2(put_hex2(out, ops[2]), ops[1]);
+            *out++ = ')';
+            return out;
+        default: // SP+r8 is written as is
+            return put_name(out, operand);
     }
-    return out.str();
 }
 
-// for more convenient stream formatting
-class Disassembler::Hex
+std::string Disassembler::pretty_disassemble(const std::vector<uint8_t> &ops,
+                                             const Execution_histogram *h, const Coverage *c)
 {
-    public:
-    explicit Hex(size_t x, int w) : x_ {x}, width_ {w} {}
-    explicit Hex(size_t x) : x_ {x}, width_ {0} {} // unspecified width
-    friend std::ostream &operator<<(std::ostream &os, const Hex &h)
+    std::string out;
+    // lines are about 30 characters, most instructions one or two bytes long
+    out.reserve(ops.size() * 24);
+    char line[128];
+    uint8_t len {0};
+    for (uint32_t pc {0}; pc < ops.size(); pc += len)
     {
-        os << std::right << std::hex << std::setfill('0')
-           << std::uppercase;
-        if (h.width_ > 0)
-             os << std::setw(h.width_) << h.x_;
-        else
-            os << h.x_;
-        return os;
+        const uint16_t bank = static_cast<uint16_t>(pc / 0x4000);
+        const uint16_t adr = static_cast<uint16_t>(bank ? 0x4000 + pc % 0x4000 : pc);
+        char *p {put_hex(line, pc, 4, false)}; // address
+        if (c && c->kind(bank, adr) == Coverage::Data)
+        {
+            len = 1;
+            p = put(p, " ");
+            p = put_hex(p, ops[pc], 2, false);
+            p = put(p, "        DB   $");
+            p = put_hex2(p, ops[pc]);
+            *p++ = '\n';
+            out.append(line, static_cast<size_t>(p - line));
+            continue;
+        }
+        const Instruction &ins {instructions[ops[pc]]};
+        len = ins.length;
+        char *const bytes {p};
+        for (uint8_t i {0}; i < ins.length && pc + i < ops.size(); ++i) // opcodes
+        {
+            *p++ = ' ';
+            p = put_hex(p, ops[pc + i], 2, false);
+        }
+        while (p - bytes < 10)
+            *p++ = ' ';
+        *p++ = ' ';
+        const Padded &name {padded_names[ops[pc]]}; // instruction
+        std::memcpy(p, name.text.data(), name.text.size());
+        p += name.length;
+        if (ins.operand1 != Operand::None)
+        {
+            *p++ = ' ';
+            p = put_name(p, ins.operand1);
+            if (ins.operand2 != Operand::None)
+            {
+                *p++ = ',';
+                p = put_name(p, ins.operand2);
+            }
+        }
+        if (h)
+        {
+            const uint64_t count {h->count(bank, adr)};
+            if (count)
+            {
+                p = put(p, "  ; ");
+                p = std::to_chars(p, line + sizeof line, count).ptr;
+            }
+        }
+        *p++ = '\n';
+        out.append(line, static_cast<size_t>(p - line));
     }
+    return out;
+}
 
-    private:
-    size_t x_;
-    int width_;
-};
-
-std::string Disassembler::parse_operand(const std::array<uint8_t, 3> &ops,
-                                const std::string &operand, size_t adr)
+size_t Disassembler::format(const std::array<uint8_t, 3> &ops, size_t adr, char *out)
 {
-    std::ostringstream out {};
-    if (operand == "a16" || operand == "d16") // 16-bit immediate
-        out << '$' << Hex(ops[2], 2) << Hex(ops[1], 2);
-    else if (operand == "r8") // 8-bit signed immediate (relative address)
+    // handle CB prefix instructions
+    const bool cb {ops[0] == 0xcb};
+    const Instruction &ins {cb ? cb_instructions[ops[1]] : instructions[ops[0]]};
+    const Padded &name {padded_names[cb ? 256u + ops[1] : ops[0]]};
+    std::memcpy(out, name.text.data(), name.text.size());
+    char *p {out + name.length};
+    // add operands (A,E; A,$12)
+    if (ins.operand1 != Operand::None)
     {
-        size_t dest_adr = adr+ops[1]+2;
-        // if the destination address is 0000-ffff, set width to 4
-        // otherwise, let ostream figure out the width
-        Hex h = (dest_adr < 0x10000) ? Hex(dest_adr, 4) : Hex(dest_adr);
-        out << '$' << h;
+        *p++ = ' ';
+        p = put_operand(p, ops, ins.operand1, adr);
+        if (ins.operand2 != Operand::None)
+        {
+            *p++ = ',';
+            p = put_operand(p, ops, ins.operand2, adr);
+        }
     }
-    else if (operand == "d8") // 8-bit unsigned immediate
-        out << '$' << Hex(ops[1], 2);
-    else if (operand == "(a8)") // 8-bit unsigned indexing
-        out << "($ff" << Hex(ops[1], 2) << ')';
-    else if (operand == "(a16)" || operand == "(d16)") // 16-bit direct
-        out << "($" << Hex(ops[2], 2) << Hex(ops[1], 2) << ')';
-    else
-        out << operand;
-    return out.str();
+    return static_cast<size_t>(p - out);
 }
 
 // ops: next 3 bytes, adr: address of the instruction (for displaying relative
@@ -95,40 +243,21 @@ std::string Disassembler::parse_operand(const std::array<uint8_t, 3> &ops,
 Assembly Disassembler::disassemble_op(const std::array<uint8_t, 3> &ops,
                                       size_t adr)
 {
-    Instruction ins;
-    // handle CB prefix instructions
-    if (ops[0] == 0xcb)
-        ins = cb_instructions[ops[1]];
-    else
-        ins = instructions[ops[0]];
+    const Instruction &ins {ops[0] == 0xcb ? cb_instructions[ops[1]] : instructions[ops[0]]};
     // disassembly of instruction (e.g.) LD A,E
-    std::ostringstream code {};
-    // get max of 2 operands if they exist
-    const std::string operand1 {ins.operand1.empty() ? "" : ins.operand1};
-    const std::string operand2 {ins.operand2.empty() ? "" : ins.operand2};
-    // use max width of 4 (LD, ADD, SBC, BIT)
-    code << std::setfill(' ') << std::left << std::setw(4) << ins.name;
-    // add operands (A,E; A,$12)
-    if (!operand1.empty())
-    {
-        code << ' ' << parse_operand(ops, operand1, adr);
-        if (!operand2.empty())
-        {
-            code << ',' << parse_operand(ops, operand2, adr);
-        }
-    }
+    char code[MAX_TEXT];
+    const size_t n {format(ops, adr, code)};
     // get the number of bytes used (3 bytes are always passed, but some
     // instructions are only 1-2 bytes long)
-    std::vector<uint8_t> ops_used(ins.length);
-    for (uint8_t i {0}; i < ins.length; ++i)
-        ops_used[i] = ops[i];
-    return Assembly {ops_used, ins, code.str()};
+    return Assembly {std::vector<uint8_t>(ops.begin(), ops.begin() + ins.length), ins,
+                     std::string(code, n)};
 }
 
 std::vector<Assembly> Disassembler::disassemble(const std::vector<uint8_t> &ops)
 {
     // disassemble a vector of bytes using the helper disassemble_op()
     std::vector<Assembly> out {};
+    out.reserve(ops.size() / 2);
     for (size_t i {0}; i < ops.size(); i += instructions[ops[i]].length)
     {
         std::array<uint8_t, 3> next_bytes {ops[i], ops[i+1], ops[i+2]};
@@ -0,0 +1,301 @@
+#include "disassembly_cache.hpp"
+#include "disassembler.hpp"
+#include "instruction_info.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace qtboy
+{
+
+// First and last address of each Region.
+static constexpr std::array<std::pair<uint16_t, uint16_t>, 7> region_bounds
+{{
+    {0x0000, 0x3fff}, {0x4000, 0x7fff}, {0x8000, 0x9fff}, {0xa000, 0xbfff},
+    {0xc000, 0xcfff}, {0xd000, 0xdfff}, {0xfe00, 0xffff},
+}};
+
+// Echo RAM mirrors c000-ddff.
+static constexpr uint16_t ECHO_FIRST {0xe000};
+static constexpr uint16_t ECHO_LAST {0xfdff};
+static constexpr uint16_t ECHO_OFFSET {0x2000};
+
+static uint8_t instruction_length(uint8_t op)
+{
+    // the CB prefix is listed as one byte, the prefixed instructions are two
+    return op == 0xcb ? 2 : instructions[op].length;
+}
+
+// Opcodes the CPU locks up on.
+static bool is_undefined(uint8_t op)
+{
+    switch (op)
+    {
+        case 0xd3: case 0xdb: case 0xdd: case 0xe3: case 0xe4: case 0xeb:
+        case 0xec: case 0xed: case 0xf4: case 0xfc: case 0xfd:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Disassembly_cache::Disassembly_cache(std::function<uint8_t(uint16_t)> read,
+                                     std::function<uint16_t(uint16_t)> bank)
+    : read_ {std::move(read)}, bank_ {std::move(bank)}
+{}
+
+void Disassembly_cache::set_rom(const Rom &rom)
+{
+    const auto first_byte = [](const Rom &r){ return r.banks() ? r.bank_data(0) : nullptr; };
+    if (first_byte(rom) == first_byte(rom_) && rom.size() == rom_.size())
+        return;
+    rom_ = rom;
+    clear();
+}
+
+Disassembly_cache::Region Disassembly_cache::region(uint16_t adr)
+{
+    if (adr < 0x8000)
+        return adr < 0x4000 ? Rom0 : Romx;
+    if (adr < 0xc000)
+        return adr < 0xa000 ? Vram : Sram;
+    if (adr < 0xe000)
+        return adr < 0xd000 ? Wram0 : Wramx;
+    return High;
+}
+
+Disassembly_cache::Block &Disassembly_cache::block(Region r, uint16_t bank)
+{
+    auto i {blocks_.find(key(r, bank))};
+    if (i == blocks_.end())
+    {
+        const auto [first, last] = region_bounds[r];
+        i = blocks_.emplace(key(r, bank),
+                            Block {first, std::vector<uint8_t>(last - first + 1u)}).first;
+    }
+    return i->second;
+}
+
+uint8_t Disassembly_cache::byte(Region r, uint16_t bank, uint16_t adr) const
+{
+    if (adr > region_bounds[r].second) // past the end of the block
+        return 0;
+    if (r == Rom0 || r == Romx)
+    {
+        if (!rom_.banks())
+            return 0xff;
+        return rom_.read(static_cast<uint16_t>(bank % rom_.banks()), adr & (Rom::Bank_size - 1));
+    }
+    return read_(adr);
+}
+
+void Disassembly_cache::add_entry(uint16_t adr)
+{
+    if (adr >= ECHO_FIRST && adr <= ECHO_LAST)
+        adr -= ECHO_OFFSET;
+    const Region r {region(adr)};
+    decode(adr, r, r == Rom0 ? 0 : bank_(adr));
+}
+
+void Disassembly_cache::add_entry(uint16_t adr, uint16_t bank)
+{
+    if (adr < 0x8000)
+        decode(adr, region(adr), adr < 0x4000 ? 0 : bank);
+}
+
+// Follow the code from adr through jumps, calls and branches within its block, and into
+// ROM0, which is always mapped. Targets in other blocks can't be decoded without knowing
+// what will be mapped there when they run, they are found when they execute.
+void Disassembly_cache::decode(uint16_t adr, Region r, uint16_t bank)
+{
+    const Block &entry_block {block(r, bank)};
+    const uint8_t &entry_length {entry_block.lengths[adr - entry_block.start]};
+    if (entry_length)
+        return; // decoded already
+    std::vector<std::tuple<uint16_t, Region, uint16_t>> pending {{adr, r, bank}};
+    while (!pending.empty())
+    {
+        auto [a, reg, b] = pending.back();
+        pending.pop_back();
+        Block &blk {block(reg, b)};
+        const uint16_t last {region_bounds[reg].second};
+        for (;;)
+        {
+            uint8_t &length {blk.lengths[a - blk.start]};
+            if (length)
+                break; // decoded already
+            const uint8_t op {byte(reg, b, a)};
+            if (is_undefined(op) || a + instruction_length(op) - 1 > last)
+                break;
+            length = instruction_length(op);
+            if (reg >= Vram)
+                mark_page(a);
+            // branch targets
+            bool target {true}, falls_through {true};
+            uint16_t t {0};
+            const auto a16 = [&]{ return static_cast<uint16_t>(byte(reg, b, a + 1)
+                                                             | byte(reg, b, a + 2) << 8); };
+            const auto r8 = [&]{ return static_cast<uint16_t>(
+                    a + 2 + static_cast<int8_t>(byte(reg, b, a + 1))); };
+            switch (op)
+            {
+                case 0xc3: t = a16(); falls_through = false; break; // JP a16
+                case 0xc2: case 0xca: case 0xd2: case 0xda: // JP cc,a16
+                case 0xc4: case 0xcc: case 0xd4: case 0xdc: case 0xcd: // CALL
+                    t = a16();
+                    break;
+                case 0x18: t = r8(); falls_through = false; break; // JR r8
+                case 0x20: case 0x28: case 0x30: case 0x38: t = r8(); break; // JR cc,r8
+                case 0xc7: case 0xcf: case 0xd7: case 0xdf: // RST
+                case 0xe7: case 0xef: case 0xf7: case 0xff:
+                    t = op & 0x38;
+                    break;
+                case 0xc9: case 0xd9: case 0xe9: // RET, RETI, JP (HL)
+                    target = falls_through = false;
+                    break;
+                default:
+                    target = false;
+                    break;
+            }
+            if (target)
+            {
+                if (t >= ECHO_FIRST && t <= ECHO_LAST)
+                    t -= ECHO_OFFSET;
+                const Region tr {region(t)};
+                if (tr == Rom0)
+                    pending.emplace_back(t, Rom0, 0);
+                else if (tr == reg)
+                    pending.emplace_back(t, reg, b);
+            }
+            if (!falls_through)
+                break;
+            a += length;
+            if (a > last || a < length) // end of block
+                break;
+        }
+    }
+    if (r <= Romx && entry_length)
+        rom_entries_.push_back({adr, bank});
+}
+
+void Disassembly_cache::seed_vectors()
+{
+    // the cartridge entry point and the interrupt vectors (RST vectors are often filler,
+    // they are found through the RSTs that use them)
+    decode(0x100, Rom0, 0);
+    for (uint16_t adr {0x40}; adr <= 0x60; adr += 8)
+        decode(adr, Rom0, 0);
+}
+
+void Disassembly_cache::invalidate_page(uint16_t adr)
+{
+    if (adr >= ECHO_FIRST && adr <= ECHO_LAST)
+        adr -= ECHO_OFFSET;
+    const Region r {region(adr)};
+    blocks_.erase(key(r, bank_(adr)));
+    // other banks of the region may still have code in the pages
+    const auto [first, last] = region_bounds[r];
+    for (unsigned page = first >> 8u; page <= last >> 8u; ++page)
+    {
+        ram_code_pages_.reset(page);
+        if (page >= 0xc0 && page + (ECHO_OFFSET >> 8) <= ECHO_LAST >> 8)
+            ram_code_pages_.reset(page + (ECHO_OFFSET >> 8));
+    }
+    for (const auto &[k, blk] : blocks_)
+    {
+        if (static_cast<Region>(k >> 16) != r)
+            continue;
+        for (std::size_t i {0}; i < blk.lengths.size(); ++i)
+        {
+            if (blk.lengths[i])
+                mark_page(static_cast<uint16_t>(blk.start + i));
+        }
+    }
+}
+
+void Disassembly_cache::mark_page(uint16_t adr)
+{
+    ram_code_pages_.set(adr >> 8);
+    if (adr >= 0xc000 && adr + ECHO_OFFSET <= ECHO_LAST) // WRAM, also written through echo
+        ram_code_pages_.set((adr + ECHO_OFFSET) >> 8);
+}
+
+void Disassembly_cache::invalidate_ram()
+{
+    for (auto i {blocks_.begin()}; i != blocks_.end();)
+        i = static_cast<Region>(i->first >> 16) >= Vram ? blocks_.erase(i) : std::next(i);
+    ram_code_pages_.reset();
+}
+
+void Disassembly_cache::clear()
+{
+    blocks_.clear();
+    ram_code_pages_.reset();
+    rom_entries_.clear();
+    seed_vectors();
+}
+
+void Disassembly_cache::append_lines(std::vector<Line> &out, Region r, uint16_t bank,
+                                     uint16_t first, uint16_t last)
+{
+    const auto i {blocks_.find(key(r, bank))};
+    if (i == blocks_.end())
+        return;
+    const Block &blk {i->second};
+    for (unsigned a {first}; a <= last;)
+    {
+        const uint8_t length {blk.lengths[a - blk.start]};
+        if (!length)
+        {
+            ++a;
+            continue;
+        }
+        Line line {static_cast<uint16_t>(a), bank, length, {}};
+        for (uint8_t j {0}; j < length; ++j)
+            line.ops[j] = byte(r, bank, static_cast<uint16_t>(a + j));
+        out.push_back(line);
+        a += length;
+    }
+}
+
+std::vector<Disassembly_cache::Line> Disassembly_cache::lines(uint16_t first, uint16_t last)
+{
+    std::vector<Line> out;
+    for (unsigned a {first}; a <= last;)
+    {
+        const bool echo {a >= ECHO_FIRST && a <= ECHO_LAST};
+        const uint16_t adr {static_cast<uint16_t>(echo ? a - ECHO_OFFSET : a)};
+        const Region r {region(adr)};
+        uint16_t end {region_bounds[r].second};
+        if (echo)
+            end = std::min<uint16_t>(end, ECHO_LAST - ECHO_OFFSET);
+        end = std::min<uint16_t>(end, static_cast<uint16_t>(echo ? last - ECHO_OFFSET : last));
+        const std::size_t n {out.size()};
+        append_lines(out, r, r == Rom0 ? 0 : bank_(adr), adr, end);
+        if (echo)
+        {
+            for (std::size_t i {n}; i < out.size(); ++i)
+                out[i].adr += ECHO_OFFSET;
+        }
+        a = (echo ? end + ECHO_OFFSET : end) + 1u;
+    }
+    return out;
+}
+
+std::vector<Disassembly_cache::Line> Disassembly_cache::rom_lines(uint16_t bank)
+{
+    std::vector<Line> out;
+    if (bank == 0)
+        append_lines(out, Rom0, 0, 0x0000, 0x3fff);
+    else
+        append_lines(out, Romx, bank, 0x4000, 0x7fff);
+    return out;
+}
+
+std::string Disassembly_cache::format(const Line &line)
+{
+    char text[Disassembler::MAX_TEXT];
+    return std::string(text, Disassembler::format(line.ops, line.adr, text));
+}
+
+}
@@ -0,0 +1,118 @@
+#include "execution_histogram.hpp"
+#include "instruction_info.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+namespace qtboy
+{
+
+static uint16_t bank_mask(std::size_t rom_banks)
+{
+    uint16_t mask {1};
+    while (mask + 1u < rom_banks)
+        mask = mask << 1 | 1;
+    return mask;
+}
+
+Execution_histogram::Execution_histogram(std::size_t rom_banks)
+    : bank_mask_ {bank_mask(rom_banks)},
+      pcs_(0x10000 + (bank_mask_ + 1u) * 0x4000u, 0)
+{}
+
+uint64_t Execution_histogram::count(uint16_t bank, uint16_t adr) const
+{
+    return pcs_[index(bank, adr, bank_mask_)];
+}
+
+uint64_t Execution_histogram::total() const
+{
+    return std::accumulate(ops_.begin(), ops_.end(), uint64_t {0});
+}
+
+std::vector<Execution_histogram::Entry> Execution_histogram::hottest(std::size_t n) const
+{
+    std::vector<Entry> entries;
+    for (uint32_t i = 0; i < pcs_.size(); ++i)
+    {
+        if (!pcs_[i])
+            continue;
+        if (i < 0x10000)
+            entries.push_back({0, static_cast<uint16_t>(i), pcs_[i]});
+        else
+            entries.push_back({static_cast<uint16_t>((i - 0x10000) / 0x4000),
+                               static_cast<uint16_t>(0x4000 + i % 0x4000), pcs_[i]});
+    }
+    const auto by_count = [](const Entry &a, const Entry &b) { return a.count > b.count; };
+    if (n < entries.size())
+    {
+        std::partial_sort(entries.begin(), entries.begin() + n, entries.end(), by_count);
+        entries.resize(n);
+    }
+    else
+    {
+        std::sort(entries.begin(), entries.end(), by_count);
+    }
+    return entries;
+}
+
+void Execution_histogram::clear()
+{
+    ops_ = {};
+    cb_ops_ = {};
+    std::fill(pcs_.begin(), pcs_.end(), 0);
+}
+
+void Execution_histogram::write_csv(std::ostream &os) const
+{
+    os << "kind,bank,address,opcode,name,count\n" << std::hex << std::setfill('0');
+    for (unsigned op = 0; op < 256; ++op)
+    {
+        if (ops_[op])
+            os << "op,,," << std::setw(2) << op << ',' << instructions[op].name << ','
+               << std::dec << ops_[op] << std::hex << '\n';
+    }
+    for (unsigned op = 0; op < 256; ++op)
+    {
+        if (cb_ops_[op])
+            os << "cb,,," << std::setw(2) << op << ',' << cb_instructions[op].name << ','
+               << std::dec << cb_ops_[op] << std::hex << '\n';
+    }
+    for (const Entry &e : hottest())
+        os << "pc," << std::setw(2) << e.bank << ',' << std::setw(4) << e.adr << ",,,"
+           << std::dec << e.count << std::hex << '\n';
+    os << std::dec << std::setfill(' ');
+}
+
+void Execution_histogram::write_json(std::ostream &os) const
+{
+    const auto write_ops = [&os](const std::array<uint64_t, 256> &ops) {
+        os << '{';
+        bool first {true};
+        for (unsigned op = 0; op < 256; ++op)
+        {
+            if (!ops[op])
+                continue;
+            os << (first ? "" : ", ") << "\"" << std::hex << std::setw(2) << op << "\": "
+               << std::dec << ops[op];
+            first = false;
+        }
+        os << '}';
+    };
+    os << std::setfill('0') << "{\"opcodes\": ";
+    write_ops(ops_);
+    os << ", \"cb_opcodes\": ";
+    write_ops(cb_ops_);
+    os << ", \"pcs\": [";
+    bool first {true};
+    for (const Entry &e : hottest())
+    {
+        os << (first ? "" : ", ") << "{\"bank\": " << e.bank << ", \"address\": \""
+           << std::hex << std::setw(4) << e.adr << "\", \"count\": " << std::dec << e.count << '}';
+        first = false;
+    }
+    os << "]}\n" << std::setfill(' ');
+}
+
+}
@@ -0,0 +1,251 @@
+#include "executor.hpp"
+#include "system.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+Executor::Executor(unsigned workers)
+{
+    if (workers == 0)
+        workers = std::thread::hardware_concurrency();
+    if (workers == 0)
+        workers = 1;
+    for (unsigned i {0}; i < workers; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i {0}; i < workers; ++i)
+        threads_.emplace_back(&Executor::work, this, i);
+}
+
+Executor::~Executor()
+{
+    if (running_)
+        stop();
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        exiting_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread &t : threads_)
+        t.join();
+}
+
+void Executor::add(std::shared_ptr<Gameboy> g)
+{
+    if (!g)
+        throw std::runtime_error {"Executor: cannot add a null Gameboy"};
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || active_ > 0)
+        throw std::runtime_error {"Executor: cannot add a Gameboy while running"};
+    instances_.push_back(std::make_unique<Instance>());
+    instances_.back()->system = std::move(g);
+    // size everything a run needs now, so running frames never allocates
+    runnable_.reserve(instances_.size());
+    for (const auto &q : queues_)
+    {
+        const std::lock_guard<std::mutex> queue_lock(q->mutex);
+        q->slices.resize(instances_.size());
+        q->head = 0;
+    }
+}
+
+std::size_t Executor::size() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return instances_.size();
+}
+
+unsigned Executor::workers() const
+{
+    return static_cast<unsigned>(threads_.size());
+}
+
+void Executor::run_frames(uint64_t frames)
+{
+    if (running_)
+        throw std::runtime_error {"Executor: already running"};
+    schedule(frames);
+    wait();
+}
+
+void Executor::start()
+{
+    if (running_)
+        return;
+    running_ = true;
+    schedule(std::numeric_limits<uint64_t>::max());
+}
+
+void Executor::stop()
+{
+    if (!running_)
+        return;
+    // workers retire each instance after its current frame instead of queueing it again
+    stopping_ = true;
+    wait();
+    stopping_ = false;
+    running_ = false;
+}
+
+uint64_t Executor::frames(std::size_t i) const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return instances_.at(i)->frames;
+}
+
+std::exception_ptr Executor::error(std::size_t i) const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return instances_.at(i)->error;
+}
+
+uint64_t Executor::total_frames() const
+{
+    return total_frames_;
+}
+
+double Executor::frames_per_second() const
+{
+    std::chrono::steady_clock::time_point start, end;
+    uint64_t frames {0};
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        start = run_start_;
+        end = active_ > 0 ? std::chrono::steady_clock::now() : run_end_;
+        frames = total_frames_ - run_start_frames_;
+    }
+    const double seconds {std::chrono::duration<double>(end - start).count()};
+    return seconds > 0 ? static_cast<double>(frames) / seconds : 0;
+}
+
+void Executor::schedule(uint64_t frames)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        runnable_.clear();
+        for (std::size_t i {0}; i < instances_.size(); ++i)
+        {
+            Instance &inst {*instances_[i]};
+            const uint64_t done {inst.frames};
+            inst.target = frames > std::numeric_limits<uint64_t>::max() - done
+                              ? std::numeric_limits<uint64_t>::max()
+                              : done + frames;
+            if (!inst.error)
+                runnable_.push_back(i);
+        }
+        active_ = frames > 0 ? runnable_.size() : 0;
+        run_start_ = std::chrono::steady_clock::now();
+        run_end_ = run_start_;
+        run_start_frames_ = total_frames_;
+    }
+    if (frames == 0)
+        return;
+    // deal the instances out round robin so every worker starts with a share
+    for (std::size_t k {0}; k < runnable_.size(); ++k)
+        push(static_cast<unsigned>(k % queues_.size()), runnable_[k]);
+}
+
+void Executor::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+void Executor::push(unsigned id, std::size_t i)
+{
+    {
+        Queue &q {*queues_[id]};
+        const std::lock_guard<std::mutex> lock(q.mutex);
+        q.slices[(q.head + q.count++) % q.slices.size()] = i;
+    }
+    {
+        // increment under mutex_ so a worker about to sleep can't miss the wakeup
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++queued_;
+    }
+    work_cv_.notify_one();
+}
+
+bool Executor::pop(unsigned id, std::size_t &i)
+{
+    // own queue first, oldest instance first so every instance gets its turn
+    {
+        Queue &q {*queues_[id]};
+        const std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.count > 0)
+        {
+            i = q.slices[q.head];
+            q.head = (q.head + 1) % q.slices.size();
+            --q.count;
+            --queued_;
+            return true;
+        }
+    }
+    // steal from the back of another worker's queue
+    for (std::size_t k {1}; k < queues_.size(); ++k)
+    {
+        Queue &q {*queues_[(id + k) % queues_.size()]};
+        const std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.count > 0)
+        {
+            i = q.slices[(q.head + --q.count) % q.slices.size()];
+            --queued_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::work(unsigned id)
+{
+    for (;;)
+    {
+        std::size_t i {0};
+        if (!pop(id, i))
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this] { return queued_ > 0 || exiting_; });
+            if (exiting_)
+                return;
+            continue;
+        }
+
+        // an instance is only ever in one queue or in flight on one worker, so it's
+        // never stepped by two threads at once
+        Instance &inst {*instances_[i]};
+        std::exception_ptr error {};
+        try
+        {
+            inst.system->execute(FRAME_CYCLES);
+        }
+        catch (...)
+        {
+            // retire the instance instead of letting the exception terminate the process
+            error = std::current_exception();
+        }
+
+        if (!error)
+        {
+            const uint64_t frames {++inst.frames};
+            ++total_frames_;
+            if (frames < inst.target && !stopping_)
+            {
+                push(id, i);
+                continue;
+            }
+        }
+
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (error)
+            inst.error = error;
+        if (--active_ == 0)
+        {
+            run_end_ = std::chrono::steady_clock::now();
+            done_cv_.notify_all();
+        }
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+#include "flight_recorder.hpp"
+#include "instruction_info.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+namespace qtboy
+{
+
+Flight_recorder::Flight_recorder()
+    : io_writes_(IO_WRITES)
+{}
+
+void Flight_recorder::allocate()
+{
+    if (instructions_.empty())
+        instructions_.resize(INSTRUCTIONS);
+}
+
+void Flight_recorder::clear()
+{
+    count_ = 0;
+    io_count_ = 0;
+}
+
+std::vector<Flight_recorder::Instruction> Flight_recorder::instructions() const
+{
+    const uint64_t n {std::min<uint64_t>(count_, INSTRUCTIONS)};
+    std::vector<Instruction> out;
+    out.reserve(static_cast<std::size_t>(n));
+    for (uint64_t i {count_ - n}; i < count_; ++i)
+        out.push_back(instructions_[i & (INSTRUCTIONS - 1)]);
+    return out;
+}
+
+std::vector<Flight_recorder::Io_write> Flight_recorder::io_writes() const
+{
+    const uint64_t n {std::min<uint64_t>(io_count_, IO_WRITES)};
+    std::vector<Io_write> out;
+    out.reserve(static_cast<std::size_t>(n));
+    for (uint64_t i {io_count_ - n}; i < io_count_; ++i)
+        out.push_back(io_writes_[i & (IO_WRITES - 1)]);
+    return out;
+}
+
+void Flight_recorder::dump(std::ostream &os) const
+{
+    const std::vector<Instruction> ins {instructions()};
+    const std::vector<Io_write> io {io_writes()};
+    const uint64_t first {count_ - ins.size()};
+    os << std::hex << std::setfill('0');
+    auto w {io.begin()};
+    // writes older than the oldest instruction held
+    for (; w != io.end() && w->instruction < first; ++w)
+        os << "  (earlier) " << std::setw(4) << w->pc << ": ff" << std::setw(2)
+           << static_cast<int>(w->adr) << " <- " << std::setw(2) << static_cast<int>(w->value)
+           << '\n';
+    for (std::size_t i {0}; i < ins.size(); ++i)
+    {
+        const Instruction &in {ins[i]};
+        const ::Instruction &info {::instructions[in.opcode]};
+        std::string code {info.name};
+        if (info.operand1 != Operand::None)
+            code.append(" ").append(operand_name(info.operand1));
+        if (info.operand2 != Operand::None)
+            code.append(",").append(operand_name(info.operand2));
+        os << std::dec << std::setfill(' ') << std::setw(10) << first + i << "  "
+           << std::hex << std::setfill('0')
+           << std::setw(2) << in.bank << ':' << std::setw(4) << in.pc << "  "
+           << std::setw(2) << static_cast<int>(in.opcode) << "  "
+           << std::left << std::setfill(' ') << std::setw(14) << code << std::right
+           << std::setfill('0')
+           << "SP:" << std::setw(4) << in.sp << " AF:" << std::setw(4) << in.af << '\n';
+        for (; w != io.end() && w->instruction == first + i; ++w)
+            os << "            ff" << std::setw(2) << static_cast<int>(w->adr) << " <- "
+               << std::setw(2) << static_cast<int>(w->value) << '\n';
+    }
+    os << std::dec;
+}
+
+}
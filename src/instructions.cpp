@@ -61,8 +61,10 @@ void Processor::ret(bool cond)
 {
     if (cond)
     {
-        pc_.lo = read(sp_++);
-        pc_.hi = read(sp_++);
+        if (call_profiler_)
+            call_profiler_->leave(static_cast<uint16_t>(sp_), cycles_);
+        pc_.lo = read_data(sp_++);
+        pc_.hi = read_data(sp_++);
     }
     else
         use_branch_cycles_ = true; // no path taken is shorter in cycle length
@@ -85,6 +87,8 @@ void Processor::call(bool cond, const uint16_t adr)
         write(pc_.hi, --sp_);
         write(pc_.lo, --sp_);
         pc_ = adr;
+        if (call_profiler_)
+            profile_call(adr);
     }
     else
         use_branch_cycles_ = true;
@@ -96,12 +100,16 @@ void Processor::rst(const uint8_t n)
     write(pc_.lo, --sp_);
     pc_.hi = 0;
     pc_.lo = n;
+    if (call_profiler_)
+        profile_call(n);
 }
 
 void Processor::reti()
 {
-    pc_.lo = read(sp_++);
-    pc_.hi = read(sp_++);
+    if (call_profiler_)
+        call_profiler_->leave(static_cast<uint16_t>(sp_), cycles_);
+    pc_.lo = read_data(sp_++);
+    pc_.hi = read_data(sp_++);
     ime_ = true;
 }
 
@@ -114,14 +122,14 @@ void Processor::push(const uint16_t rp)
 
 void Processor::pop(Register_pair &rp)
 {
-    rp.lo = read(sp_++);
-    rp.hi = read(sp_++);
+    rp.lo = read_data(sp_++);
+    rp.hi = read_data(sp_++);
 }
 
 void Processor::pop_af()
 {
-    af_.lo = read(sp_++);
-    af_.hi = read(sp_++);
+    af_.lo = read_data(sp_++);
+    af_.hi = read_data(sp_++);
     af_.lo &= 0xf0; // the lower 4 bits of the f register are unused
 }
 
@@ -159,7 +167,7 @@ void Processor::inc(uint8_t &r)
 
 void Processor::inc_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     inc(b);
     write(b, adr);
 }
@@ -174,7 +182,7 @@ void Processor::dec(uint8_t &r)
 
 void Processor::dec_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     dec(b);
     write(b, adr);
 }
@@ -325,7 +333,7 @@ void Processor::rlca()
 
 void Processor::rlc_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     rlc(b);
     write(b, adr);
 }
@@ -350,7 +358,7 @@ void Processor::rrca()
 
 void Processor::rrc_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     rrc(b);
     write(b, adr);
 }
@@ -374,7 +382,7 @@ void Processor::rla()
 
 void Processor::rl_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     rl(b);
     write(b, adr);
 }
@@ -399,7 +407,7 @@ void Processor::rr(uint8_t &r)
 
 void Processor::rr_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     rr(b);
     write(b, adr);
 }
@@ -415,7 +423,7 @@ void Processor::sla(uint8_t &r)
 
 void Processor::sla_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     sla(b);
     write(b, adr);
 }
@@ -432,7 +440,7 @@ void Processor::sra(uint8_t &r)
 
 void Processor::sra_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     sra(b);
     write(b, adr);
 }
@@ -450,7 +458,7 @@ void Processor::swap(uint8_t &r)
 
 void Processor::swap_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     swap(b);
     write(b, adr);
 }
@@ -466,7 +474,7 @@ void Processor::srl(uint8_t &r)
 
 void Processor::srl_i(uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     srl(b);
     write(b, adr);
 }
@@ -485,7 +493,7 @@ void Processor::res(const uint8_t n, uint8_t &r)
 
 void Processor::res_i(uint8_t n, uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     res(n, b);
     write(b, adr);
 }
@@ -497,7 +505,7 @@ void Processor::set(const uint8_t n, uint8_t &r)
 
 void Processor::set_i(uint8_t n, uint16_t adr)
 {
-    uint8_t b {read(adr)};
+    uint8_t b {read_data(adr)};
     set(n, b);
     write(b, adr);
 }
@@ -11,6 +11,14 @@ Joypad::Joypad(Processor &p)
     : cpu_ {p}
 {}
 
+void Joypad::copy_state(const Joypad &other)
+{
+    directions_ = other.directions_;
+    buttons_ = other.buttons_;
+    select_button_ = other.select_button_;
+    select_direction_ = other.select_direction_;
+}
+
 void Joypad::press(Input i)
 {
     update_button(i, true);
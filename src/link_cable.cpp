@@ -0,0 +1,149 @@
+#include "link_cable.hpp"
+#include "system.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+Link_cable::Link_cable(Gameboy &a, Gameboy &b, uint64_t max_skew)
+    : max_skew_ {std::max<uint64_t>(max_skew, 2)}
+{
+    if (&a == &b)
+        throw std::runtime_error {"Link_cable: cannot connect a Gameboy to itself"};
+    ends_[0].system = &a;
+    ends_[1].system = &b;
+    a.set_serial_callback([this](uint8_t byte) { return transfer(0, byte); });
+    b.set_serial_callback([this](uint8_t byte) { return transfer(1, byte); });
+}
+
+Link_cable::~Link_cable()
+{
+    stop();
+    for (End &e : ends_)
+        e.system->set_serial_callback(nullptr);
+}
+
+void Link_cable::run_for(uint64_t cycles)
+{
+    launch(cycles);
+    join();
+}
+
+void Link_cable::start()
+{
+    launch(std::numeric_limits<uint64_t>::max());
+}
+
+void Link_cable::stop()
+{
+    stopping_ = true;
+    join();
+}
+
+void Link_cable::launch(uint64_t cycles)
+{
+    if (ends_[0].thread.joinable() || ends_[1].thread.joinable())
+        throw std::runtime_error {"Link_cable: already running"};
+    stopping_ = false;
+    for (End &e : ends_)
+    {
+        e.base = e.system->elapsed_cycles();
+        e.target = cycles;
+        e.time = 0;
+        e.mailbox = Idle;
+        e.done = false;
+    }
+    for (std::size_t i {0}; i < ends_.size(); ++i)
+        ends_[i].thread = std::thread {&Link_cable::run, this, i};
+}
+
+void Link_cable::join()
+{
+    for (End &e : ends_)
+    {
+        if (e.thread.joinable())
+            e.thread.join();
+    }
+}
+
+void Link_cable::run(std::size_t i)
+{
+    End &me {ends_[i]};
+    End &peer {ends_[1 - i]};
+    // run half the allowed skew at a time so running one quantum past the peer's clock
+    // still stays within max_skew_ of it
+    const uint64_t quantum {max_skew_ / 2};
+    while (!stopping_ && me.time < me.target)
+    {
+        // wait for the peer to catch up instead of getting too far ahead
+        for (;;)
+        {
+            service(i);
+            if (stopping_ || peer.done)
+                break;
+            const uint64_t now {me.time}, peer_now {peer.time};
+            if (now + quantum <= peer_now + max_skew_)
+            {
+                const uint64_t skew {now > peer_now ? now - peer_now : peer_now - now};
+                uint64_t seen {max_observed_skew_};
+                while (skew > seen && !max_observed_skew_.compare_exchange_weak(seen, skew))
+                    ;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        me.system->execute(std::min(quantum, me.target - me.time));
+        me.time = me.system->elapsed_cycles() - me.base;
+    }
+    me.done = true;
+    // keep answering until the peer is done, so it never waits on an end that has stopped
+    while (!stopping_ && !peer.done)
+    {
+        service(i);
+        std::this_thread::yield();
+    }
+}
+
+void Link_cable::service(std::size_t i)
+{
+    End &me {ends_[i]};
+    if (me.mailbox.load(std::memory_order_acquire) != Request)
+        return;
+    me.out = me.system->link_transfer(me.in);
+    me.mailbox.store(Reply, std::memory_order_release);
+}
+
+uint8_t Link_cable::transfer(std::size_t i, uint8_t b)
+{
+    End &peer {ends_[1 - i]};
+    if (peer.done || stopping_)
+        return 0xff; // nothing on the other end
+    peer.in = b;
+    peer.mailbox.store(Request, std::memory_order_release);
+    for (;;)
+    {
+        if (peer.mailbox.load(std::memory_order_acquire) == Reply)
+        {
+            const uint8_t received {peer.out};
+            peer.mailbox.store(Idle, std::memory_order_release);
+            ++transfers_;
+            return received;
+        }
+        // the peer may be clocking a byte into this end at the same time
+        service(i);
+        if (stopping_)
+        {
+            // withdraw the request unless the peer already answered it
+            int expected {Request};
+            if (peer.mailbox.compare_exchange_strong(expected, Idle))
+                return 0xff;
+            continue;
+        }
+        std::this_thread::yield();
+    }
+}
+
+}
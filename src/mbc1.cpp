@@ -11,6 +11,15 @@ Mbc1::Mbc1(Rom *rom, std::optional<External_ram> *ram)
     : rom_ {rom}, ram_ {ram}
 {}
 
+std::unique_ptr<Memory_bank_controller> Mbc1::clone(Rom *rom,
+                                                    std::optional<External_ram> *ram) const
+{
+    std::unique_ptr<Mbc1> m {new Mbc1 {*this}};
+    m->rom_ = rom;
+    m->ram_ = ram;
+    return m;
+}
+
 uint8_t Mbc1::read(uint16_t adr) const
 {
 	uint8_t b {0xff};
@@ -12,6 +12,15 @@ Mbc2::Mbc2(Rom *rom)
       ram_(512)
 {}
 
+std::unique_ptr<Memory_bank_controller> Mbc2::clone(Rom *rom,
+                                                    std::optional<External_ram> *) const
+{
+    // built-in RAM is copied along with the banking state
+    std::unique_ptr<Mbc2> m {new Mbc2 {*this}};
+    m->rom_ = rom;
+    return m;
+}
+
 uint8_t Mbc2::read(uint16_t adr) const
 {
     uint8_t b {0xff};
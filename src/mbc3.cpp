@@ -20,6 +20,15 @@ Mbc3::Mbc3(Rom *rom, std::optional<External_ram> *ram)
 
 }
 
+std::unique_ptr<Memory_bank_controller> Mbc3::clone(Rom *rom,
+                                                    std::optional<External_ram> *ram) const
+{
+    std::unique_ptr<Mbc3> m {new Mbc3 {*this}};
+    m->rom_ = rom;
+    m->ram_ = ram;
+    return m;
+}
+
 uint8_t Mbc3::read(uint16_t adr) const
 {
     uint8_t b {0xff};
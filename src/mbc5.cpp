@@ -11,6 +11,15 @@ Mbc5::Mbc5(Rom *rom, std::optional<External_ram> *ram)
     : rom_ {rom}, ram_ {ram}
 {}
 
+std::unique_ptr<Memory_bank_controller> Mbc5::clone(Rom *rom,
+                                                    std::optional<External_ram> *ram) const
+{
+    std::unique_ptr<Mbc5> m {new Mbc5 {*this}};
+    m->rom_ = rom;
+    m->ram_ = ram;
+    return m;
+}
+
 uint8_t Mbc5::read(uint16_t adr) const
 {
     uint8_t b {0xff};
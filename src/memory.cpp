@@ -5,6 +5,7 @@
 #include "joypad.hpp"
 #include "exception.hpp"
 #include "apu.hpp"
+#include "serial.hpp"
 
 #include <cstdint>
 // #include <QDebug>
@@ -12,12 +13,13 @@
 namespace qtboy
 {
 
-Memory::Memory(Processor &c, Ppu &p, Timer &t, Joypad &j, Apu &a)
+Memory::Memory(Processor &c, Ppu &p, Timer &t, Joypad &j, Apu &a, Serial &s)
     : cpu_ {c},
       ppu_ {p},
       timer_ {t},
       joypad_ {j},
-      apu_ {a}
+      apu_ {a},
+      serial_ {s}
 {
     init_io();
 }
@@ -102,6 +104,8 @@ uint8_t Memory::read(uint16_t adr) const
     {
         if (adr == 0xff00)
             b = joypad_.read_reg();
+        else if (adr == 0xff01 || adr == 0xff02) // serial registers
+            b = serial_.read(adr);
         else if (adr > 0xff03 && adr < 0xff08) // timer registers
             b = timer_.read(adr);
         else if (adr > 0xff0f && adr < 0xff40) // APU registers
@@ -174,12 +178,9 @@ void Memory::write(uint8_t b, uint16_t adr)
 {
     if (!cart_) // no cartridge inserted
         return;
-    if (debug_mode_)
+    if (debug_mode_ && debug_callback_)
         debug_callback_(b, adr);
     /*
-    if (adr == 0xff02 && b == 0x81)
-            // qStdOut() << static_cast<char>(read(0xff01));
-            // std::cout << static_cast<char>(read(0xff01));
     // don't include ROM in memory logging b/c it shouldn't change
     // don't include echo RAM (WRAM log will handle it)
     // don't include unused portion
@@ -198,6 +199,8 @@ void Memory::write(uint8_t b, uint16_t adr)
     if (adr < 0x8000) // enabling flags (dependant on MBC)
     {
         cart_->write(b, adr);
+        // the CPU counts executions per bank:PC
+        cpu_.set_rom_bank(cart_->rom_bank());
     }
     else if (adr < 0xa000) // VRAM accessing
     {
@@ -263,6 +266,8 @@ void Memory::write(uint8_t b, uint16_t adr)
     {
         if (adr == 0xff00)
             joypad_.write_reg(b);
+        else if (adr == 0xff01 || adr == 0xff02) // serial registers
+            serial_.write(b, adr);
         else if (adr > 0xff03 && adr < 0xff08) // timer registers
             timer_.write(b, adr);
         else if (adr > 0xff0f && adr < 0xff40) // APU registers
@@ -356,9 +361,33 @@ void Memory::vram_write(uint8_t b, uint8_t bank, uint16_t a)
 }
 
 
+uint16_t Memory::bank(uint16_t adr) const
+{
+    if (adr >= 0xe000 && adr < 0xfe00) // echo RAM
+        adr -= 0x2000;
+    if (adr >= 0x4000 && adr < 0x8000)
+        return cart_ ? cart_->rom_bank() : 1;
+    if (adr >= 0x8000 && adr < 0xa000)
+        return cgb_mode_ ? io_[0x4f] & 1 : 0;
+    if (adr >= 0xa000 && adr < 0xc000)
+        return cart_ ? cart_->ram_bank() : 0;
+    if (adr >= 0xd000 && adr < 0xe000)
+    {
+        const uint8_t b = cgb_mode_ ? io_[0x70] & 7 : 1;
+        return b ? b : 1;
+    }
+    return 0;
+}
+
 Cartridge *Memory::load_cartridge(std::istream &is)
 {
-    cart_ = std::make_unique<Cartridge>(is);
+    return load_cartridge(Rom {is});
+}
+
+Cartridge *Memory::load_cartridge(Rom rom)
+{
+    cart_ = std::make_unique<Cartridge>(std::move(rom));
+    cpu_.set_rom_bank(cart_->rom_bank());
     set_ram_size();
     if (cart_->is_cgb())
         cgb_mode_ = true;
@@ -383,6 +412,65 @@ void Memory::reset()
     hdma_len_ = 0xff;
 }
 
+void Memory::dump_mapped(uint16_t first, std::size_t n, uint8_t *out) const
+{
+    // the banks dump_mapped() shows
+    const uint8_t wram_bank = (io_[0x70] & 7) ? io_[0x70] & 7 : 1,
+                  vram_bank = io_[0x4f] & 1;
+    for (std::size_t i {0}; i < n; ++i)
+    {
+        const uint16_t adr = static_cast<uint16_t>(first + i);
+        uint16_t a = adr < 0xe000 || adr >= 0xfe00 ? adr : adr - 0x2000; // echo RAM
+        uint8_t b {0};
+        if (a < 0x8000 || (a >= 0xa000 && a < 0xc000))
+            b = cart_ ? cart_->dump_byte(a) : 0;
+        else if (a < 0xa000)
+            b = vram_.read(vram_bank, a - 0x8000);
+        else if (a < 0xd000)
+            b = wram_.read(0, a - 0xc000);
+        else if (a < 0xe000)
+            b = wram_.read(wram_bank, a - 0xd000);
+        else if (a < 0xfea0)
+            b = oam_[a - 0xfe00];
+        else if (a < 0xff00) // unused
+            b = 0;
+        else if (a < 0xff80)
+            b = io_[a - 0xff00];
+        else if (a < 0xffff)
+            b = hram_[a - 0xff80];
+        else
+            b = ie_;
+        out[i] = b;
+    }
+}
+
+std::string Memory::mapped_name(uint16_t adr) const
+{
+    if (adr < 0x4000)
+        return "ROM0";
+    if (adr < 0x8000)
+        return "ROM" + std::to_string(cart_ ? cart_->rom_bank() : 1);
+    if (adr < 0xa000)
+        return "VRM" + std::to_string(io_[0x4f] & 1);
+    if (adr < 0xc000)
+    {
+        if (!cart_)
+            return "RAM0";
+        return cart_->has_ram() ? "RAM" + std::to_string(cart_->ram_bank()) : "RAMX";
+    }
+    if (adr < 0xd000)
+        return "WRM0";
+    if (adr < 0xe000)
+        return "WRM" + std::to_string((io_[0x70] & 7) ? io_[0x70] & 7 : 1);
+    if (adr < 0xfe00)
+        return "ECHO";
+    if (adr < 0xfea0)
+        return "OAM";
+    if (adr < 0xff00)
+        return "UNUS";
+    return adr < 0xff80 ? "IO" : "HRAM";
+}
+
 std::vector<uint8_t> Memory::dump_rom() const
 {
     return (cart_ ? cart_->dump_rom() : std::vector<uint8_t> {});
@@ -459,6 +547,28 @@ void Memory::load_memory(const Memory::Dump &dump)
     ie_ = dump.ie;
 }
 
+void Memory::copy_state(const Memory &other)
+{
+    if (!other.cart_)
+        cart_.reset();
+    else if (cart_)
+        *cart_ = *other.cart_;
+    else
+        cart_ = std::make_unique<Cartridge>(*other.cart_);
+    vram_ = other.vram_;
+    wram_ = other.wram_;
+    oam_ = other.oam_;
+    io_ = other.io_;
+    hram_ = other.hram_;
+    ie_ = other.ie_;
+    cgb_mode_ = other.cgb_mode_;
+    hdma_active_ = other.hdma_active_;
+    hdma_src_ = other.hdma_src_;
+    hdma_dest_ = other.hdma_dest_;
+    hdma_len_ = other.hdma_len_;
+    sram_written_ = other.sram_written_;
+}
+
 Memory::Dump Memory::dump_memory() const
 {
     return Memory::Dump {vram_, wram_, oam_, io_, hram_, ie_};
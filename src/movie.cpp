@@ -0,0 +1,112 @@
+#include "movie.hpp"
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+/*** MOVIE FILE FORMAT (text, one record per line)
+QTBOY-MOVIE 1
+title <rom title>
+interval <cycles between checkpoints>
+press <cycle> <input>
+release <cycle> <input>
+hash <cycle> <64-bit state hash in hex>
+***/
+
+static const std::array<const char *, 8> input_names
+{
+    "A", "B", "Right", "Left", "Up", "Down", "Start", "Select"
+};
+
+static Joypad::Input parse_input(const std::string &name)
+{
+    for (size_t i {0}; i < input_names.size(); ++i)
+        if (name == input_names[i])
+            return static_cast<Joypad::Input>(i);
+    throw std::runtime_error {"Movie: unknown input " + name};
+}
+
+Movie::Movie(uint64_t checkpoint_interval)
+    : checkpoint_interval_ {checkpoint_interval}
+{}
+
+void Movie::add_input(uint64_t cycle, Joypad::Input i, bool pressed)
+{
+    inputs_.push_back({cycle, i, pressed});
+}
+
+void Movie::add_checkpoint(uint64_t cycle, uint64_t hash)
+{
+    checkpoints_.push_back({cycle, hash});
+}
+
+bool Movie::save(const std::string &path) const
+{
+    std::ofstream out {path};
+    if (!out)
+        return false;
+    out << "QTBOY-MOVIE 1\n"
+        << "title " << title_ << '\n'
+        << "interval " << checkpoint_interval_ << '\n';
+    for (const Input_event &e : inputs_)
+        out << (e.pressed ? "press " : "release ") << e.cycle << ' '
+            << input_names[static_cast<size_t>(e.input)] << '\n';
+    for (const Checkpoint &c : checkpoints_)
+        out << "hash " << c.cycle << ' ' << std::hex << std::setw(16) << std::setfill('0')
+            << c.hash << std::dec << '\n';
+    return static_cast<bool>(out);
+}
+
+Movie Movie::load(const std::string &path)
+{
+    std::ifstream in {path};
+    if (!in)
+        throw std::runtime_error {"Movie: could not open " + path};
+    std::string line;
+    if (!std::getline(in, line) || line != "QTBOY-MOVIE 1")
+        throw std::runtime_error {"Movie: " + path + " is not a movie file"};
+    Movie m {};
+    while (std::getline(in, line))
+    {
+        std::istringstream ss {line};
+        std::string key;
+        ss >> key;
+        if (key == "title")
+        {
+            // titles may contain spaces (or be empty)
+            std::getline(ss >> std::ws, m.title_);
+            continue;
+        }
+        else if (key == "interval")
+        {
+            ss >> m.checkpoint_interval_;
+        }
+        else if (key == "press" || key == "release")
+        {
+            uint64_t cycle {0};
+            std::string input;
+            ss >> cycle >> input;
+            m.add_input(cycle, parse_input(input), key == "press");
+        }
+        else if (key == "hash")
+        {
+            uint64_t cycle {0}, hash {0};
+            ss >> cycle >> std::hex >> hash;
+            m.add_checkpoint(cycle, hash);
+        }
+        else if (!key.empty())
+        {
+            throw std::runtime_error {"Movie: unknown record " + key};
+        }
+        if (ss.fail())
+            throw std::runtime_error {"Movie: malformed line: " + line};
+    }
+    return m;
+}
+
+}
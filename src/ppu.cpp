@@ -8,6 +8,7 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 #define CHANGE_BIT(b, n, x) b ^= (-x ^ b) & (1UL << n)
 #define CLEAR_BIT(b, n) b &= ~(1UL << n)
@@ -34,6 +35,34 @@ Ppu::Ppu(Memory &m,
       renderer_ {r}
 {}
 
+void Ppu::copy_state(const Ppu &other)
+{
+    clock_ = other.clock_;
+    window_line_ = other.window_line_;
+    lcdc_ = other.lcdc_;
+    stat_ = other.stat_;
+    scy_ = other.scy_;
+    scx_ = other.scx_;
+    ly_ = other.ly_;
+    lyc_ = other.lyc_;
+    bgp_ = other.bgp_;
+    obp0_ = other.obp0_;
+    obp1_ = other.obp1_;
+    wy_ = other.wy_;
+    wx_ = other.wx_;
+    sprites_ = other.sprites_;
+    stat_signal_ = other.stat_signal_;
+    cgb_mode_ = other.cgb_mode_;
+    bgpd_ = other.bgpd_;
+    obpd_ = other.obpd_;
+    bgpi_ = other.bgpi_;
+    obpi_ = other.obpi_;
+    color_correction = other.color_correction;
+    brightness = other.brightness;
+    // the output frame in progress belongs to the old state
+    std::fill(out_acc_.begin(), out_acc_.end(), 0);
+}
+
 void Ppu::reset()
 {
     clock_ = 0;
@@ -57,6 +86,7 @@ void Ppu::reset()
     obpd_ = {};
     bgpi_ = 0;
     obpi_ = 0;
+    std::fill(out_acc_.begin(), out_acc_.end(), 0);
 }
 
 void Ppu::enable_cgb(bool is_cgb)
@@ -201,6 +231,41 @@ void Ppu::set_renderer(Renderer *r)
     renderer_ = r;
 }
 
+void Ppu::set_profiler(Profiler *p)
+{
+    profiler_ = p;
+}
+
+void Ppu::set_output(Output o, unsigned width, unsigned height)
+{
+    if (width == 0 || height == 0 || width > 160 || height > 144)
+        throw std::out_of_range {"PPU: output size must be within 160x144"};
+    output_ = o;
+    out_w_ = width;
+    out_h_ = height;
+    // bin every screen pixel into the output pixel it falls on
+    for (unsigned x {0}; x < 160; ++x)
+        out_col_[x] = static_cast<uint16_t>(x * width / 160);
+    for (unsigned y {0}; y < 144; ++y)
+        out_row_[y] = static_cast<uint16_t>(y * height / 144);
+    out_area_.assign(width * height, 0);
+    for (unsigned y {0}; y < 144; ++y)
+        for (unsigned x {0}; x < 160; ++x)
+            ++out_area_[out_row_[y] * width + out_col_[x]];
+    out_acc_.assign(width * height, 0);
+    out_frame_.assign(width * height, 0);
+}
+
+Ppu::Output Ppu::output() const
+{
+    return output_;
+}
+
+const std::vector<uint8_t> &Ppu::output_frame() const
+{
+    return out_frame_;
+}
+
 Texture Ppu::get_framebuffer(bool with_bg, bool with_win,
                              bool with_sprites) const
 {
@@ -254,11 +319,14 @@ Texture Ppu::get_tile(uint8_t bank, uint16_t i) const
 Texture Ppu::get_layer(Layer l) const
 {
     Texture tex(256, 256);
+    std::array<Palette, 8> pals {};
+    for (uint8_t i = 0; i < 8; ++i)
+        pals[i] = get_bg_palette(i);
     for (unsigned y = 0; y < 256; ++y)
     {
         for (unsigned x = 0; x < 256; ++x)
         {
-            render_layer_pixel(tex, l, x, y, x, y);
+            render_layer_pixel(tex, l, x, y, x, y, pals);
         }
     }
     return tex;
@@ -308,7 +376,11 @@ void Ppu::write_vram(uint8_t b, uint8_t bank, uint16_t adr)
 
 void Ppu::render_scanline()
 {
-    Texture tex {160, 1};
+    Texture &tex {line_};
+    update_line_palettes();
+    // white in the current output format
+    const Color white = output_ == Output::Rgb ? 0xffff
+                      : output_ == Output::Luminance ? 0xff : 0;
     // STOP mode: if LCD is on, set to all white, if off, all black
     if (false && cpu_.stopped())
     {
@@ -317,6 +389,8 @@ void Ppu::render_scanline()
     }
     else
     {
+        // every path below sets the priority of all 160 pixels, so the
+        // previous line's priorities never leak into this one
         if (lcdc_ & 1 || cgb_mode_) // bg/window enable
         {
             render_layer_line(tex, Ppu::Layer::Background);
@@ -326,13 +400,81 @@ void Ppu::render_scanline()
         // background and window appear white if lcdc bit 0 is cleared
         else
         {
-            Color c(0xffff);
-            tex.fill(c);
+            tex.fill(white);
         }
         if (lcdc_ & 1 << 1) // OBJ display enable
             render_sprite_line(tex);
     }
-    renderer_->draw_texture(tex, 0, ly_);
+    if (profiler_)
+        profiler_->enter(output_ == Output::Rgb ? Profiler::Component::Renderer
+                                                  : Profiler::Component::Ppu_present);
+    if (output_ == Output::Rgb)
+        renderer_->draw_texture(tex, 0, ly_);
+    else
+        output_scanline();
+    if (profiler_)
+        profiler_->leave();
+}
+
+// luminance (0-255) of a raw RGB555 color, without color correction
+static uint8_t luminance(uint16_t rgb)
+{
+    const unsigned r = rgb & 0x1f,
+            g = rgb >> 5 & 0x1f,
+            b = rgb >> 10 & 0x1f;
+    return static_cast<uint8_t>((r * 77 + g * 150 + b * 29) * 255 / (31 * 256));
+}
+
+void Ppu::update_line_palettes()
+{
+    if (output_ == Output::Rgb)
+    {
+        // DMG mode only uses background palette 0 and sprite palettes 0-1
+        const uint8_t n = cgb_mode_ ? 8 : 1;
+        for (uint8_t i = 0; i < n; ++i)
+            line_bg_pals_[i] = get_bg_palette(i);
+        for (uint8_t i = 0; i < std::max<uint8_t>(n, 2); ++i)
+            line_sprite_pals_[i] = get_sprite_palette(i);
+        return;
+    }
+    const bool lum = output_ == Output::Luminance;
+    if (cgb_mode_)
+    {
+        for (uint8_t p = 0; p < 8; ++p)
+        {
+            for (uint8_t i = 0; i < 4; ++i)
+            {
+                const uint8_t bg = static_cast<uint8_t>(p*8 + i*2);
+                line_bg_pals_[p][i] = lum ? luminance(bgpd_[bg] | bgpd_[bg+1] << 8) : i;
+                line_sprite_pals_[p][i] = lum ? luminance(obpd_[bg] | obpd_[bg+1] << 8) : i;
+            }
+        }
+        return;
+    }
+    // DMG: the shade a palette register maps each color index to
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        const uint8_t bg = (bgp_ >> i*2) & 3, ob0 = (obp0_ >> i*2) & 3, ob1 = (obp1_ >> i*2) & 3;
+        line_bg_pals_[0][i] = static_cast<uint16_t>(lum ? 0xff - bg * 0x55 : bg);
+        line_sprite_pals_[0][i] = static_cast<uint16_t>(lum ? 0xff - ob0 * 0x55 : ob0);
+        line_sprite_pals_[1][i] = static_cast<uint16_t>(lum ? 0xff - ob1 * 0x55 : ob1);
+    }
+}
+
+void Ppu::output_scanline()
+{
+    uint32_t *acc {out_acc_.data() + out_row_[ly_] * out_w_};
+    for (unsigned x = 0; x < 160; ++x)
+        acc[out_col_[x]] += line_.pixel(x);
+}
+
+void Ppu::output_frame_done()
+{
+    for (size_t i = 0; i < out_acc_.size(); ++i)
+    {
+        out_frame_[i] = static_cast<uint8_t>(out_acc_[i] / out_area_[i]);
+        out_acc_[i] = 0;
+    }
 }
 
 void Ppu::render_layer_line(Texture &tex, Ppu::Layer layer)
@@ -364,7 +506,7 @@ void Ppu::render_layer_line(Texture &tex, Ppu::Layer layer)
         uint8_t x = (layer == Ppu::Layer::Background)
                 ? x_px + scx_
                 : x_px - (wx_-7);
-        render_layer_pixel(tex, layer, x, y, x_px, 0);
+        render_layer_pixel(tex, layer, x, y, x_px, 0, line_bg_pals_);
         ++window_pxs_drawn;
     }
     if (layer == Ppu::Layer::Window && window_pxs_drawn != 0)
@@ -374,7 +516,8 @@ void Ppu::render_layer_line(Texture &tex, Ppu::Layer layer)
 // render the layer pixel at (tex_x,tex_y) with the color at (x, y) in VRAM
 void Ppu::render_layer_pixel(Texture &tex, Ppu::Layer layer,
                              uint8_t x, uint8_t y,
-                             uint8_t tex_x, uint8_t tex_y) const
+                             uint8_t tex_x, uint8_t tex_y,
+                             const std::array<Palette, 8> &pals) const
 {
     uint16_t tile_map = 0x9800;
     if (layer == Ppu::Layer::Background)
@@ -434,7 +577,7 @@ void Ppu::render_layer_pixel(Texture &tex, Ppu::Layer layer,
     // (or last) pixel
     bool hi_bit = (hi_byte & 1 << (7-px_offset));
     bool lo_bit = (lo_byte & 1 << (7-px_offset));
-    Palette pal(get_bg_palette(tile_attr & 7));
+    const Palette &pal {pals[tile_attr & 7]};
     // get pixel color index
     // bit of hi byte is the hi bit of the 2-bit color index in the palette
     // bit of lo byte is the lo bit of the 2-bit color index in the palette
@@ -516,8 +659,8 @@ void Ppu::render_sprite_line(Texture &tex)
         uint8_t low_byte = read_vram(bank, adr);
         uint8_t high_byte = read_vram(bank, adr+1);
         // if CGB: palette is in attribute bits 0-2, otherwise bit 4
-        uint8_t pal_idx = (cgb_mode_) ? (s.attr & 7) : (s.attr & 1 << 4);
-        Palette pal = get_sprite_palette(pal_idx);
+        uint8_t pal_idx = (cgb_mode_) ? (s.attr & 7) : (s.attr >> 4 & 1);
+        const Palette &pal {line_sprite_pals_[pal_idx]};
         bool ob_priority = s.attr & 1 << 7;
         for (uint8_t px = 0; px < 8; ++px)
         {
@@ -714,7 +857,11 @@ void Ppu::oam_scan()
     if (clock_ >= 80)
     {
         clock_ -= 80;
+        if (profiler_)
+            profiler_->enter(Profiler::Component::Ppu_oam_scan);
         load_sprites();
+        if (profiler_)
+            profiler_->leave();
         SET_BIT(stat_, 1);
         SET_BIT(stat_, 0); // mode 3
     }
@@ -726,9 +873,15 @@ void Ppu::vram_read()
     if (clock_ >= 172)
     {
         clock_ -= 172;
-        if (!renderer_)
-            return;
-        render_scanline();
+        // headless instances (no renderer) skip drawing but keep the PPU timing
+        if (renderer_ || output_ != Output::Rgb)
+        {
+            if (profiler_)
+                profiler_->enter(Profiler::Component::Ppu_render);
+            render_scanline();
+            if (profiler_)
+                profiler_->leave();
+        }
         // enter hblank
         CLEAR_BIT(stat_, 1);
         CLEAR_BIT(stat_, 0); // mode 0
@@ -751,9 +904,20 @@ void Ppu::hblank()
             CLEAR_BIT(stat_, 1); // mode 1
             SET_BIT(stat_, 0);
             cpu_.request_interrupt(Processor::Interrupt::VBLANK);
-            if (!renderer_)
-                return;
-            renderer_->present_screen();
+            if (profiler_)
+                profiler_->enter(output_ == Output::Rgb ? Profiler::Component::Renderer
+                                                          : Profiler::Component::Ppu_present);
+            if (output_ != Output::Rgb && output_held_)
+                std::fill(out_acc_.begin(), out_acc_.end(), 0);
+            else if (output_ != Output::Rgb)
+                output_frame_done();
+            else if (renderer_)
+                renderer_->present_screen();
+            if (profiler_)
+            {
+                profiler_->leave();
+                profiler_->end_frame();
+            }
         }
         else
         {
@@ -42,6 +42,60 @@ Processor::Processor(std::function<uint8_t(uint16_t)> rd,
     reset();
 }
 
+void Processor::copy_state(const Processor &other)
+{
+    // the callbacks capture the Gameboy that owns this processor, keep ours, and keep
+    // counting into our own histogram (or scratch counters) and recording into our own
+    // flight recorder and coverage
+    auto rd {std::move(read)};
+    auto wr {std::move(write)};
+    const bool counting {counters_.ops != scratch_.data()};
+    const Counters counters {counters_};
+    Call_profiler *call_profiler {call_profiler_};
+    Flight_recorder *flight_recorder {flight_recorder_};
+    Coverage *coverage {coverage_};
+    if (call_profiler)
+        call_profiler->sync(cycles_);
+    *this = other;
+    read = std::move(rd);
+    write = std::move(wr);
+    counters_ = counting ? counters : scratch_counters();
+    call_profiler_ = call_profiler;
+    flight_recorder_ = flight_recorder;
+    coverage_ = coverage;
+    // the call stack it tracked is gone
+    if (call_profiler_)
+        call_profiler_->restart(cycles_);
+}
+
+void Processor::set_call_profiler(Call_profiler *p)
+{
+    if (call_profiler_)
+        call_profiler_->sync(cycles_);
+    call_profiler_ = p;
+    if (call_profiler_)
+        call_profiler_->sync(cycles_);
+}
+
+void Processor::profile_call(uint16_t adr)
+{
+    call_profiler_->enter((adr & 0xc000) == 0x4000 ? rom_bank_ : 0, adr,
+                          static_cast<uint16_t>(sp_), cycles_);
+}
+
+void Processor::set_histogram(Execution_histogram *h)
+{
+    if (h)
+        counters_ = {h->ops_.data(), h->cb_ops_.data(), h->pcs_.data(), 0xffffffff, h->bank_mask_};
+    else
+        counters_ = scratch_counters();
+}
+
+Processor::Counters Processor::scratch_counters() noexcept
+{
+    return {scratch_.data(), scratch_.data(), scratch_.data() + 256, 0, 0};
+}
+
 void Processor::reset(bool force_dmg)
 {
     af_ = force_dmg ? 0x01b0 : 0x11b0;
@@ -91,7 +145,11 @@ void Processor::set_flag(Flags f, bool cond)
 
 uint8_t Processor::fetch8()
 {
+    if (coverage_)
+        coverage_->mark_code(rom_bank_, PC);
+    fetching_ = true;
     uint8_t op = read(PC);
+    fetching_ = false;
     // HALT bug: the processor fails to increment the PC
     if (halt_bug_)
         halt_bug_ = false;
@@ -129,6 +187,8 @@ bool Processor::execute_interrupt(Interrupt i)
     write(pc_.lo, --sp_);
     pc_.hi = 0;
     pc_.lo = 0x40 + i*8;
+    if (call_profiler_)
+        profile_call(pc_);
     ime_ = false;
     write(0, 0xff0f); // clear IF
     return true;
@@ -185,7 +245,14 @@ void Processor::step()
         cycles_ += 4; // assume NOP when CPU is halted
         return;
     }
+    ++counters_.pcs[Execution_histogram::index(rom_bank_, PC, counters_.bank_mask)
+                    & counters_.pc_mask];
+    const uint16_t pc {PC};
     uint8_t op {fetch8()};
+    uint8_t op2 {0}; // the opcode after a CB prefix
+    ++counters_.ops[op];
+    if (flight_recorder_)
+        flight_recorder_->record(pc, (pc & 0xc000) == 0x4000 ? rom_bank_ : 0, sp_, af_, op);
     switch (op)
     {
         // misc and control
@@ -248,10 +315,10 @@ void Processor::step()
         case 0x36: ldr(HL, fetch8()); break;
         case 0x3e: ld(A, fetch8()); break;
 
-        case 0x0a: ld(A, read(BC)); break;
-        case 0x1a: ld(A, read(DE)); break;
-        case 0x2a: ld(A, read(HL++)); break;
-        case 0x3a: ld(A, read(HL--)); break;
+        case 0x0a: ld(A, read_data(BC)); break;
+        case 0x1a: ld(A, read_data(DE)); break;
+        case 0x2a: ld(A, read_data(HL++)); break;
+        case 0x3a: ld(A, read_data(HL--)); break;
 
         case 0x40: break;
         case 0x41: ld(B, C); break;
@@ -259,7 +326,7 @@ void Processor::step()
         case 0x43: ld(B, E); break;
         case 0x44: ld(B, H); break;
         case 0x45: ld(B, L); break;
-        case 0x46: ld(B, read(HL)); break;
+        case 0x46: ld(B, read_data(HL)); break;
         case 0x47: ld(B, A); break;
 
         case 0x48: ld(C, B); break;
@@ -268,7 +335,7 @@ void Processor::step()
         case 0x4b: ld(C, E); break;
         case 0x4c: ld(C, H); break;
         case 0x4d: ld(C, L); break;
-        case 0x4e: ld(C, read(HL)); break;
+        case 0x4e: ld(C, read_data(HL)); break;
         case 0x4f: ld(C, A); break;
 
         case 0x50: ld(D, B); break;
@@ -277,7 +344,7 @@ void Processor::step()
         case 0x53: ld(D, E); break;
         case 0x54: ld(D, H); break;
         case 0x55: ld(D, L); break;
-        case 0x56: ld(D, read(HL)); break;
+        case 0x56: ld(D, read_data(HL)); break;
         case 0x57: ld(D, A); break;
 
         case 0x58: ld(E, B); break;
@@ -286,7 +353,7 @@ void Processor::step()
         case 0x5b: break;
         case 0x5c: ld(E, H); break;
         case 0x5d: ld(E, L); break;
-        case 0x5e: ld(E, read(HL)); break;
+        case 0x5e: ld(E, read_data(HL)); break;
         case 0x5f: ld(E, A); break;
 
         case 0x60: ld(H, B); break;
@@ -295,7 +362,7 @@ void Processor::step()
         case 0x63: ld(H, E); break;
         case 0x64: break;
         case 0x65: ld(H, L); break;
-        case 0x66: ld(H, read(HL)); break;
+        case 0x66: ld(H, read_data(HL)); break;
         case 0x67: ld(H, A); break;
 
         case 0x68: ld(L, B); break;
@@ -304,7 +371,7 @@ void Processor::step()
         case 0x6b: ld(L, E); break;
         case 0x6c: ld(L, H); break;
         case 0x6d: break;
-        case 0x6e: ld(L, read(HL)); break;
+        case 0x6e: ld(L, read_data(HL)); break;
         case 0x6f: ld(L, A); break;
 
         case 0x70: ldr(HL, B); break;
@@ -321,15 +388,15 @@ void Processor::step()
         case 0x7b: ld(A, E); break;
         case 0x7c: ld(A, H); break;
         case 0x7d: ld(A, L); break;
-        case 0x7e: ld(A, read(HL)); break;
+        case 0x7e: ld(A, read_data(HL)); break;
         case 0x7f: break;
 
         case 0xe0: ldd(IO_MEMORY + fetch8(), A); break; // ldh (a8),A
         case 0xea: ldd(fetch16(), A); break; // ld (a16),A
-        case 0xf0: ld(A, read(IO_MEMORY + fetch8())); break; // ldh A,(a8)
-        case 0xfa: ld(A, read(fetch16())); break; // ldh A,(a16)
+        case 0xf0: ld(A, read_data(IO_MEMORY + fetch8())); break; // ldh A,(a8)
+        case 0xfa: ld(A, read_data(fetch16())); break; // ldh A,(a16)
         case 0xe2: ldd(IO_MEMORY + C, A); break; // ld (C),A
-        case 0xf2: ld(A, read(IO_MEMORY + C)); break; // ld A,(C)
+        case 0xf2: ld(A, read_data(IO_MEMORY + C)); break; // ld A,(C)
 
         // 16-bit load
         case 0x01: ld(BC, fetch16()); break;
@@ -381,7 +448,7 @@ void Processor::step()
         case 0x83: adc(E, false); break;
         case 0x84: adc(H, false); break;
         case 0x85: adc(L, false); break;
-        case 0x86: adc(read(HL), false); break;
+        case 0x86: adc(read_data(HL), false); break;
         case 0x87: adc(A, false); break;
 
         case 0x88: adc(B, get_flag(CARRY)); break;
@@ -390,7 +457,7 @@ void Processor::step()
         case 0x8b: adc(E, get_flag(CARRY)); break;
         case 0x8c: adc(H, get_flag(CARRY)); break;
         case 0x8d: adc(L, get_flag(CARRY)); break;
-        case 0x8e: adc(read(HL), get_flag(CARRY)); break;
+        case 0x8e: adc(read_data(HL), get_flag(CARRY)); break;
         case 0x8f: adc(A, get_flag(CARRY)); break;
 
         case 0x90: sbc(B, false); break;
@@ -399,7 +466,7 @@ void Processor::step()
         case 0x93: sbc(E, false); break;
         case 0x94: sbc(H, false); break;
         case 0x95: sbc(L, false); break;
-        case 0x96: sbc(read(HL), false); break;
+        case 0x96: sbc(read_data(HL), false); break;
         case 0x97: sbc(A, false); break;
 
         case 0x98: sbc(B, get_flag(CARRY)); break;
@@ -408,7 +475,7 @@ void Processor::step()
         case 0x9b: sbc(E, get_flag(CARRY)); break;
         case 0x9c: sbc(H, get_flag(CARRY)); break;
         case 0x9d: sbc(L, get_flag(CARRY)); break;
-        case 0x9e: sbc(read(HL), get_flag(CARRY)); break;
+        case 0x9e: sbc(read_data(HL), get_flag(CARRY)); break;
         case 0x9f: sbc(A, get_flag(CARRY)); break;
 
         case 0xa0: andr(B); break;
@@ -417,7 +484,7 @@ void Processor::step()
         case 0xa3: andr(E); break;
         case 0xa4: andr(H); break;
         case 0xa5: andr(L); break;
-        case 0xa6: andr(read(HL)); break;
+        case 0xa6: andr(read_data(HL)); break;
         case 0xa7: andr(A); break;
 
         case 0xa8: xorr(B); break;
@@ -426,7 +493,7 @@ void Processor::step()
         case 0xab: xorr(E); break;
         case 0xac: xorr(H); break;
         case 0xad: xorr(L); break;
-        case 0xae: xorr(read(HL)); break;
+        case 0xae: xorr(read_data(HL)); break;
         case 0xaf: xorr(A); break;
 
         case 0xb0: orr(B); break;
@@ -435,7 +502,7 @@ void Processor::step()
         case 0xb3: orr(E); break;
         case 0xb4: orr(H); break;
         case 0xb5: orr(L); break;
-        case 0xb6: orr(read(HL)); break;
+        case 0xb6: orr(read_data(HL)); break;
         case 0xb7: orr(A); break;
 
         case 0xb8: cp(B); break;
@@ -444,7 +511,7 @@ void Processor::step()
         case 0xbb: cp(E); break;
         case 0xbc: cp(H); break;
         case 0xbd: cp(L); break;
-        case 0xbe: cp(read(HL)); break;
+        case 0xbe: cp(read_data(HL)); break;
         case 0xbf: cp(A); break;
 
         case 0xc6: adc(fetch8(), false); break;
@@ -483,8 +550,8 @@ void Processor::step()
         // prefix cb
         case 0xcb:
         {
-
-            switch (fetch8())
+            op2 = fetch8();
+            switch (op2)
             {
                 case 0x00: rlc(B); break;
                 case 0x01: rlc(C); break;
@@ -567,7 +634,7 @@ void Processor::step()
                 case 0x43: bit(0, E); break;
                 case 0x44: bit(0, H); break;
                 case 0x45: bit(0, L); break;
-                case 0x46: bit(0, read(HL)); break;
+                case 0x46: bit(0, read_data(HL)); break;
                 case 0x47: bit(0, A); break;
 
                 case 0x48: bit(1, B); break;
@@ -576,7 +643,7 @@ void Processor::step()
                 case 0x4b: bit(1, E); break;
                 case 0x4c: bit(1, H); break;
                 case 0x4d: bit(1, L); break;
-                case 0x4e: bit(1, read(HL)); break;
+                case 0x4e: bit(1, read_data(HL)); break;
                 case 0x4f: bit(1, A); break;
 
                 case 0x50: bit(2, B); break;
@@ -585,7 +652,7 @@ void Processor::step()
                 case 0x53: bit(2, E); break;
                 case 0x54: bit(2, H); break;
                 case 0x55: bit(2, L); break;
-                case 0x56: bit(2, read(HL)); break;
+                case 0x56: bit(2, read_data(HL)); break;
                 case 0x57: bit(2, A); break;
 
                 case 0x58: bit(3, B); break;
@@ -594,7 +661,7 @@ void Processor::step()
                 case 0x5b: bit(3, E); break;
                 case 0x5c: bit(3, H); break;
                 case 0x5d: bit(3, L); break;
-                case 0x5e: bit(3, read(HL)); break;
+                case 0x5e: bit(3, read_data(HL)); break;
                 case 0x5f: bit(3, A); break;
 
                 case 0x60: bit(4, B); break;
@@ -603,7 +670,7 @@ void Processor::step()
                 case 0x63: bit(4, E); break;
                 case 0x64: bit(4, H); break;
                 case 0x65: bit(4, L); break;
-                case 0x66: bit(4, read(HL)); break;
+                case 0x66: bit(4, read_data(HL)); break;
                 case 0x67: bit(4, A); break;
 
                 case 0x68: bit(5, B); break;
@@ -612,7 +679,7 @@ void Processor::step()
                 case 0x6b: bit(5, E); break;
                 case 0x6c: bit(5, H); break;
                 case 0x6d: bit(5, L); break;
-                case 0x6e: bit(5, read(HL)); break;
+                case 0x6e: bit(5, read_data(HL)); break;
                 case 0x6f: bit(5, A); break;
 
                 case 0x70: bit(6, B); break;
@@ -621,7 +688,7 @@ void Processor::step()
                 case 0x73: bit(6, E); break;
                 case 0x74: bit(6, H); break;
                 case 0x75: bit(6, L); break;
-                case 0x76: bit(6, read(HL)); break;
+                case 0x76: bit(6, read_data(HL)); break;
                 case 0x77: bit(6, A); break;
 
                 case 0x78: bit(7, B); break;
@@ -630,7 +697,7 @@ void Processor::step()
                 case 0x7b: bit(7, E); break;
                 case 0x7c: bit(7, H); break;
                 case 0x7d: bit(7, L); break;
-                case 0x7e: bit(7, read(HL)); break;
+                case 0x7e: bit(7, read_data(HL)); break;
                 case 0x7f: bit(7, A); break;
 
                 case 0x80: res(0, B); break;
@@ -788,9 +855,8 @@ void Processor::step()
     // handle cycle timings of CB prefix instructions
     if (op == 0xcb)
     {
-        // get op after prefix
-        uint8_t op2 = read(PC-1);
         cycles_passed = cb_instructions[op2].cycles;
+        ++counters_.cb_ops[op2];
 
     }
     // handle all other instructions
@@ -0,0 +1,121 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace qtboy
+{
+
+const std::array<const char *, Profiler::COMPONENTS> Profiler::component_names
+{
+    "other", "cpu", "memory", "ppu", "ppu_oam_scan", "ppu_render", "ppu_present", "apu",
+    "timer", "renderer"
+};
+
+Profiler::Profiler(std::size_t history)
+    : history_(history == 0 ? 1 : history),
+      start_ticks_ {now()},
+      start_time_ {std::chrono::steady_clock::now()}
+{}
+
+void Profiler::end_frame()
+{
+    charge(now());
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t c = 0; c < COMPONENTS; ++c)
+    {
+        totals_.ticks[c] += current_.ticks[c];
+        totals_.calls[c] += current_.calls[c];
+    }
+    history_[next_] = current_;
+    next_ = (next_ + 1) % history_.size();
+    ++frame_count_;
+    current_ = {};
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fill(history_.begin(), history_.end(), Raw_frame {});
+    next_ = 0;
+    frame_count_ = 0;
+    totals_ = {};
+    current_ = {};
+}
+
+std::vector<Profiler::Frame> Profiler::frames() const
+{
+    const double scale {ns_per_tick()};
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::size_t n = std::min<uint64_t>(frame_count_, history_.size());
+    std::vector<Frame> frames;
+    frames.reserve(n);
+    // the oldest frame kept is the next one to be overwritten once the ring is full
+    std::size_t i = (next_ + history_.size() - n) % history_.size();
+    for (std::size_t k = 0; k < n; ++k, i = (i + 1) % history_.size())
+        frames.push_back(to_frame(history_[i].ticks, history_[i].calls, scale));
+    return frames;
+}
+
+Profiler::Frame Profiler::totals() const
+{
+    const double scale {ns_per_tick()};
+    std::lock_guard<std::mutex> lock(mutex_);
+    return to_frame(totals_.ticks, totals_.calls, scale);
+}
+
+uint64_t Profiler::frame_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frame_count_;
+}
+
+void Profiler::write_csv(std::ostream &os) const
+{
+    os << "frame,total_ns";
+    for (const char *name : component_names)
+        os << ',' << name << "_ns," << name << "_calls";
+    os << '\n';
+    const std::vector<Frame> frames {this->frames()};
+    const uint64_t first {frame_count() - frames.size()};
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        os << first + i << ',' << static_cast<uint64_t>(frames[i].total_ns);
+        for (std::size_t c = 0; c < COMPONENTS; ++c)
+            os << ',' << static_cast<uint64_t>(frames[i].ns[c]) << ',' << frames[i].calls[c];
+        os << '\n';
+    }
+}
+
+double Profiler::ns_per_tick() const
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // give the measurement at least a few milliseconds to be accurate
+    auto elapsed = std::chrono::steady_clock::now() - start_time_;
+    if (elapsed < std::chrono::milliseconds(10))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+        elapsed = std::chrono::steady_clock::now() - start_time_;
+    }
+    const uint64_t ticks {now() - start_ticks_};
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ticks);
+#else
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration {1}).count();
+#endif
+}
+
+Profiler::Frame Profiler::to_frame(const std::array<uint64_t, COMPONENTS> &ticks,
+                                   const std::array<uint64_t, COMPONENTS> &calls,
+                                   double scale) const
+{
+    Frame f;
+    for (std::size_t c = 0; c < COMPONENTS; ++c)
+    {
+        f.ns[c] = static_cast<double>(ticks[c]) * scale;
+        f.calls[c] = calls[c];
+        f.total_ns += f.ns[c];
+    }
+    return f;
+}
+
+}
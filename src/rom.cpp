@@ -1,42 +1,183 @@
 #include "rom.hpp"
 
 #include <istream>
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
 #include <iomanip>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h> // open()
+#include <sys/mman.h> // mmap()
+#include <sys/stat.h> // fstat()
+#include <unistd.h> // close()
+#endif
 
 namespace qtboy
 {
-	
+
+// Map the whole file at path read-only. Returns nullptr if the file can't be mapped
+// (nonexistent, empty, or mapping unsupported), in which case the caller falls back
+// to reading through a stream.
+static void *map_file(const std::string &path, size_t &size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER len {};
+    if (!GetFileSizeEx(file, &len) || len.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+    // the view keeps the mapping alive after its handle is closed
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+        return nullptr;
+    size = static_cast<size_t>(len.QuadPart);
+    return view;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    void *base = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (base == MAP_FAILED)
+        return nullptr;
+    size = static_cast<size_t>(st.st_size);
+    return base;
+#endif
+}
+
+class Rom::Image
+{
+    public:
+    explicit Image(std::vector<uint8_t> buffer)
+        : buffer_ {std::move(buffer)}, data_ {buffer_.data()}, size_ {buffer_.size()}
+    {}
+
+    Image(void *mapping, size_t size)
+        : data_ {static_cast<const uint8_t *>(mapping)}, size_ {size}, mapping_ {mapping}
+    {}
+
+    Image(const Image &) = delete;
+    Image &operator=(const Image &) = delete;
+
+    ~Image()
+    {
+        if (!mapping_)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(mapping_);
+#else
+        ::munmap(mapping_, size_);
+#endif
+    }
+
+    const uint8_t *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool is_mapped() const { return mapping_ != nullptr; }
+
+    private:
+    std::vector<uint8_t> buffer_ {}; // only used when loaded from a stream
+    const uint8_t *data_ {nullptr};
+    size_t size_ {0};
+    void *mapping_ {nullptr}; // base of the file mapping, nullptr if not mapped
+};
+
 Rom::Rom(std::istream &is)
 {
 	if (!is.good())
         throw std::runtime_error {"ROM: Invalid input stream!\n"};
-    Bank buf {};
-	while (is.read(reinterpret_cast<char *>(buf.data()), buf.size()))
-        data_.push_back(buf);
+    // read everything, including a trailing bank shorter than 16 KB
+    std::vector<uint8_t> buffer(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>{});
+    image_ = std::make_shared<const Image>(std::move(buffer));
+    data_ = image_->data();
+    size_ = image_->size();
+}
+
+Rom::Rom(const std::string &path)
+{
+    size_t size {0};
+    if (void *mapping = map_file(path, size))
+    {
+        image_ = std::make_shared<const Image>(mapping, size);
+        data_ = image_->data();
+        size_ = image_->size();
+        return;
+    }
+    // mapping failed, copy the file through a stream instead
+    std::ifstream is {path, std::ios::binary};
+    *this = Rom {is};
 }
 
-uint8_t Rom::read(uint8_t bank, uint16_t adr) const
+uint8_t Rom::read(uint16_t bank, uint16_t adr) const
 {
-	if (bank > data_.size() || adr > data_[0].size())
+    const size_t i = static_cast<size_t>(bank) * Bank_size + adr;
+	if (bank >= banks() || adr >= Bank_size)
 		throw std::out_of_range {"Invalid ROM address"};
-	return data_[bank][adr];
+    // bytes past the end of a partial last bank read as open bus
+    return i < size_ ? data_[i] : 0xff;
 }
-	
-std::vector<uint8_t> Rom::dump(uint8_t bank) const
+
+const uint8_t *Rom::bank_data(uint16_t bank) const
 {
-    if (bank > data_.size())
+    if (bank >= banks())
         throw std::out_of_range {"Invalid bank selection"};
-    return std::vector<uint8_t>(data_[bank].begin(), data_[bank].end());
+    return data_ + static_cast<size_t>(bank) * Bank_size;
 }
 
-std::vector<uint8_t> Rom::dump() const
+size_t Rom::banks() const
 {
-    std::vector<uint8_t> out {};
-    out.reserve(data_.size() * data_[0].size());
-    for (size_t bank {0}; bank < data_.size(); ++bank)
-        out.insert(out.end(), data_[bank].begin(), data_[bank].end());
+    return (size_ + Bank_size - 1) / Bank_size;
+}
+
+size_t Rom::size() const
+{
+    return size_;
+}
+
+bool Rom::is_mapped() const
+{
+    return image_ && image_->is_mapped();
+}
+
+long Rom::use_count() const
+{
+    return image_.use_count();
+}
+
+std::vector<uint8_t> Rom::dump(uint16_t bank) const
+{
+    const uint8_t *begin {bank_data(bank)};
+    const size_t len = std::min<size_t>(Bank_size, size_ - (begin - data_));
+    std::vector<uint8_t> out(begin, begin + len);
+    // pad a partial last bank so every dumped bank is 16 KB
+    out.resize(Bank_size, 0xff);
     return out;
 }
-	
+
+std::vector<uint8_t> Rom::dump() const
+{
+    return std::vector<uint8_t>(data_, data_ + size_);
+}
+
 }
@@ -0,0 +1,99 @@
+#include "serial.hpp"
+#include "processor.hpp"
+
+namespace qtboy
+{
+
+Serial::Serial(Processor &p)
+    : cpu_ {p}
+{}
+
+void Serial::copy_state(const Serial &other)
+{
+    sb_ = other.sb_;
+    sc_ = other.sc_;
+    cycles_left_ = other.cycles_left_;
+    cgb_mode_ = other.cgb_mode_;
+}
+
+void Serial::set_transfer_callback(Transfer_callback cb)
+{
+    transfer_callback_ = std::move(cb);
+}
+
+void Serial::enable_cgb(bool is_cgb)
+{
+    cgb_mode_ = is_cgb;
+}
+
+void Serial::update(std::size_t cycles)
+{
+    // only internally clocked transfers make progress on their own
+    if (!transferring() || !internal_clock())
+        return;
+    cycles_left_ -= static_cast<int>(cycles);
+    if (cycles_left_ > 0)
+        return;
+    complete(transfer_callback_ ? transfer_callback_(sb_) : 0xff);
+}
+
+uint8_t Serial::external_transfer(uint8_t b)
+{
+    if (!transferring() || internal_clock())
+        return 0xff;
+    const uint8_t sent {sb_};
+    complete(b);
+    return sent;
+}
+
+void Serial::complete(uint8_t received)
+{
+    sb_ = received;
+    sc_ &= 0x7f;
+    cycles_left_ = 0;
+    cpu_.request_interrupt(Processor::SERIAL);
+}
+
+uint8_t Serial::read(uint16_t adr) const
+{
+    uint8_t b {0xff};
+    switch (adr)
+    {
+        case 0xff01: // SB
+            b = sb_;
+            break;
+        case 0xff02: // SC: unused bits read as 1 (bit 1 is the CGB clock speed)
+            b = sc_ | (cgb_mode_ ? 0x7c : 0x7e);
+            break;
+    }
+    return b;
+}
+
+void Serial::write(uint8_t b, uint16_t adr)
+{
+    switch (adr)
+    {
+        case 0xff01: // SB
+            sb_ = b;
+            break;
+        case 0xff02: // SC
+        {
+            sc_ = b & (cgb_mode_ ? 0x83 : 0x81);
+            if (transferring() && internal_clock())
+            {
+                const bool fast {cgb_mode_ && (sc_ & 2)};
+                cycles_left_ = 8 * (fast ? FAST_CYCLES_PER_BIT : CYCLES_PER_BIT);
+            }
+        } break;
+    }
+}
+
+void Serial::reset()
+{
+    sb_ = 0;
+    sc_ = 0;
+    cycles_left_ = 0;
+    cgb_mode_ = false;
+}
+
+}
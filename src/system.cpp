@@ -7,6 +7,7 @@
 #include <thread>
 #include <chrono>
 #include <memory>
+#include <algorithm>
 
 #include "system.hpp"
 #include "exception.hpp"
@@ -18,12 +19,13 @@ using std::chrono::nanoseconds;
 namespace qtboy
 {
 
-Gameboy::Gameboy()
-{}
+Gameboy::Gameboy() = default;
 
 Gameboy::~Gameboy()
 {
     stop();
+    if (!write_save_on_exit_)
+        return;
     // save data on close
     std::vector<uint8_t> sram(memory_.dump_sram());
     // only save data if any save data was modified
@@ -51,15 +53,21 @@ std::string stem(const std::string &path)
 
 bool Gameboy::load_cartridge(const std::string &path)
 {
-    std::ifstream rom {path, std::ios::binary};
-    if (!rom.good())
+    if (!std::ifstream {path, std::ios::binary}.good())
         return false;
-    rom_title_ = stem(path);
-    // load the ROM into a cartridge in memory
+    // map the ROM file into memory (no copy of the ROM is made)
+    return load_cartridge(Rom {path}, stem(path));
+}
+
+bool Gameboy::load_cartridge(const Rom &rom, const std::string &title)
+{
+    rom_title_ = title;
+    // the cartridge shares the ROM image with rom
     Cartridge *cart {memory_.load_cartridge(rom)};
     cgb_mode_ = (cart->is_cgb() && !force_dmg_);
     ppu_.enable_cgb(cgb_mode_);
     memory_.enable_cgb(cgb_mode_);
+    serial_.enable_cgb(cgb_mode_);
     memory_.load_save(save_dir_ + "/" + rom_title_ + ".sav");
     rom_loaded_ = true;
     return true;
@@ -77,6 +85,17 @@ void Gameboy::set_speaker(std::shared_ptr<Speaker> s)
     apu_.set_speaker(std::move(s));
 }
 
+void Gameboy::set_output(Ppu::Output o, unsigned width, unsigned height)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    ppu_.set_output(o, width, height);
+}
+
+const std::vector<uint8_t> &Gameboy::output_frame() const
+{
+    return ppu_.output_frame();
+}
+
 void Gameboy::run()
 {
     emu_paused_ = false;
@@ -127,6 +146,8 @@ void Gameboy::resume()
         return;
     std::lock_guard<std::mutex> lock(mutex_);
     emu_paused_ = false;
+    debug_break_ = false;
+    watch_hit_.reset();
     // notify emu_thread_ to start running again
     pause_cv_.notify_one();
 }
@@ -140,15 +161,53 @@ void Gameboy::reset()
     apu_.reset();
     timer_.reset();
     joypad_.reset();
+    serial_.reset();
     rom_title_ = {};
     rom_loaded_ = false;
+    elapsed_cycles_ = 0;
+    debug_break_ = false;
+    skip_breakpoint_ = false;
+    watch_hit_.reset();
+    watch_pending_ = false;
+    flight_recorder_.clear();
+    history_.clear();
+    input_log_.clear();
+    if (history_size_)
+        next_snapshot_ = 0;
+    movie_mode_ = Movie_mode::None;
+    const std::lock_guard<std::mutex> lock(input_mutex_);
+    input_queue_.clear();
+    input_pending_ = false;
 }
 
 size_t Gameboy::step(size_t n)
+{
+    try
+    {
+        return step_instructions(n);
+    }
+    catch (const std::exception &e)
+    {
+        write_crash_dump(e);
+        throw;
+    }
+}
+
+size_t Gameboy::step_instructions(size_t n)
 {
     size_t cycles_passed = 0;
+    // the flight recorder's ring is only allocated once this Gameboy runs
+    if (!flight_recorder_.allocated())
+    {
+        flight_recorder_.allocate();
+        cpu_.set_flight_recorder(&flight_recorder_);
+    }
+    if (profiling_)
+        profiler_->resume();
     for (size_t i = 0; i < n; ++i)
     {
+        if (elapsed_cycles_ >= next_snapshot_)
+            take_snapshot();
         // run an optional debug callback (set with set_debug_callback())
         // after each CPU instruction
         if (debug_mode_)
@@ -156,36 +215,529 @@ size_t Gameboy::step(size_t n)
             // debug callback returns a boolean indicating a desired break
             debug_break_ = cpu_debug_callback_();
             if (debug_break_)
+            {
+                emu_paused_ = true;
+                break;
+            }
+        }
+        if (breakpoints_.maybe(cpu_.pc()))
+        {
+            if (skip_breakpoint_)
+            {
+                skip_breakpoint_ = false;
+            }
+            else if (breakpoints_enabled_
+                     && breakpoints_.hit(cpu_.pc(), memory_.bank(cpu_.pc()), cpu_, memory_))
+            {
+                debug_break_ = true;
+                skip_breakpoint_ = true;
+                emu_paused_ = true;
                 break;
+            }
         }
+        // live input waits while history is replayed, logged input is applied instead
+        if (input_pending_ && !replaying_)
+            apply_queued_input();
+        if (movie_mode_ != Movie_mode::None)
+            update_movie();
         size_t old_cycles {cpu_.cycles()};
+        instruction_pc_ = cpu_.pc();
+        if (cpu_trace_)
+            cpu_trace_->record(make_trace_record());
+        if (watchpoints_.trapped(instruction_pc_, Watchpoints::Execute))
+            watch(instruction_pc_, memory_read(instruction_pc_), Watchpoints::Execute);
+        if (profiling_)
+            profiler_->switch_to(Profiler::Component::Cpu);
         cpu_.step();
-        cycles_passed += (cpu_.cycles() - old_cycles);
-        ppu_.step(cycles_passed);
-        timer_.update(cycles_passed);
-        apu_.tick(cycles_passed);
+        // components only advance by the cycles of this instruction
+        const size_t cycles {cpu_.cycles() - old_cycles};
+        elapsed_cycles_ += cycles;
+        cycles_passed += cycles;
+        if (profiling_)
+            profiler_->switch_to(Profiler::Component::Ppu);
+        ppu_.step(cycles);
+        // the timer is computed from elapsed_cycles_, it only runs to handle an overflow
+        if (elapsed_cycles_ >= timer_.next_event())
+        {
+            if (profiling_)
+                profiler_->switch_to(Profiler::Component::Timer);
+            timer_.update();
+        }
+        if (profiling_)
+            profiler_->switch_to(Profiler::Component::Apu);
+        apu_.tick(cycles);
+        if (profiling_)
+            profiler_->switch_to(Profiler::Component::Other);
+        serial_.update(cycles);
+        // a watchpoint stops emulation once the instruction that triggered it completes
+        if (watch_pending_)
+        {
+            watch_pending_ = false;
+            debug_break_ = true;
+            emu_paused_ = true;
+            break;
+        }
     }
+    if (profiling_)
+        profiler_->pause();
     return cycles_passed;
 }
 
 size_t Gameboy::execute(size_t cyc)
 {
     size_t cycles_passed = 0;
+    // time between instructions counts as well, not just the time inside step()
+    if (profiling_)
+        profiler_->resume();
     // continuously step 1 CPU instruction until the specified number of cycles have
     // passed or until debug_callback_ requests a break
     while (cycles_passed < cyc && !debug_break_)
         cycles_passed += step(1);
+    if (profiling_)
+        profiler_->pause();
     return cycles_passed;
 }
 
 void Gameboy::press(Joypad::Input i)
 {
-    joypad_.press(i);
+    const std::lock_guard<std::mutex> lock(input_mutex_);
+    input_queue_.emplace_back(i, true);
+    input_pending_ = true;
 }
 
 void Gameboy::release(Joypad::Input i)
 {
-    joypad_.release(i);
+    const std::lock_guard<std::mutex> lock(input_mutex_);
+    input_queue_.emplace_back(i, false);
+    input_pending_ = true;
+}
+
+void Gameboy::apply_queued_input()
+{
+    const std::lock_guard<std::mutex> lock(input_mutex_);
+    input_pending_ = false;
+    // live input is ignored while a movie is playing back
+    if (movie_mode_ != Movie_mode::Playing)
+    {
+        for (const auto &in : input_queue_)
+        {
+            if (in.second)
+                joypad_.press(in.first);
+            else
+                joypad_.release(in.first);
+            if (movie_mode_ == Movie_mode::Recording)
+                movie_.add_input(elapsed_cycles_ - movie_start_, in.first, in.second);
+            if (history_size_)
+                input_log_.push_back({elapsed_cycles_, in.first, in.second});
+        }
+    }
+    input_queue_.clear();
+}
+
+void Gameboy::update_movie()
+{
+    const uint64_t now {elapsed_cycles_ - movie_start_};
+    if (movie_mode_ == Movie_mode::Recording)
+    {
+        if (now >= next_checkpoint_)
+        {
+            movie_.add_checkpoint(now, state_hash());
+            next_checkpoint_ = now + movie_.checkpoint_interval();
+        }
+        return;
+    }
+    // playing: inputs were recorded at instruction boundaries, so they come due exactly
+    const std::vector<Movie::Input_event> &inputs {movie_.inputs()};
+    for (; movie_input_ < inputs.size() && inputs[movie_input_].cycle <= now; ++movie_input_)
+    {
+        if (inputs[movie_input_].pressed)
+            joypad_.press(inputs[movie_input_].input);
+        else
+            joypad_.release(inputs[movie_input_].input);
+    }
+    const std::vector<Movie::Checkpoint> &checkpoints {movie_.checkpoints()};
+    if (movie_checkpoint_ < checkpoints.size() && checkpoints[movie_checkpoint_].cycle <= now)
+    {
+        const Movie::Checkpoint &c {checkpoints[movie_checkpoint_++]};
+        if (!movie_desynced_ && (c.cycle != now || c.hash != state_hash()))
+        {
+            movie_desynced_ = true;
+            std::cout << "Movie desynced at cycle " << c.cycle << ".\n";
+        }
+    }
+    // playback ends once everything in the movie has been replayed
+    if (movie_input_ == inputs.size() && movie_checkpoint_ == checkpoints.size())
+        movie_mode_ = Movie_mode::None;
+}
+
+void Gameboy::record_movie(uint64_t checkpoint_interval)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    movie_ = Movie {checkpoint_interval};
+    movie_.set_title(rom_title_);
+    movie_mode_ = Movie_mode::Recording;
+    movie_start_ = elapsed_cycles_;
+    next_checkpoint_ = 0;
+}
+
+void Gameboy::play_movie(Movie m)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    movie_ = std::move(m);
+    movie_mode_ = Movie_mode::Playing;
+    movie_start_ = elapsed_cycles_;
+    movie_input_ = 0;
+    movie_checkpoint_ = 0;
+    movie_desynced_ = false;
+}
+
+Movie Gameboy::stop_movie()
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    movie_mode_ = Movie_mode::None;
+    return std::move(movie_);
+}
+
+bool Gameboy::movie_playing() const
+{
+    return movie_mode_ == Movie_mode::Playing;
+}
+
+bool Gameboy::movie_desynced() const
+{
+    return movie_desynced_;
+}
+
+std::unique_ptr<Gameboy> Gameboy::clone() const
+{
+    auto g {std::make_unique<Gameboy>()};
+    g->write_save_on_exit_ = false;
+    const std::scoped_lock lock(mutex_, g->mutex_);
+    g->copy_state(*this);
+    return g;
+}
+
+void Gameboy::restore(const Gameboy &other)
+{
+    if (this == &other)
+        return;
+    const std::scoped_lock lock(mutex_, other.mutex_);
+    copy_state(other);
+    movie_mode_ = Movie_mode::None;
+    // a breakpoint at the restored PC breaks as usual
+    skip_breakpoint_ = false;
+    watch_hit_.reset();
+    watch_pending_ = false;
+    // the history belongs to the timeline left behind
+    history_.clear();
+    input_log_.clear();
+    if (history_size_)
+        next_snapshot_ = elapsed_cycles_;
+    const std::lock_guard<std::mutex> input_lock(input_mutex_);
+    input_queue_.clear();
+    input_pending_ = false;
+}
+
+void Gameboy::set_history(bool b, uint64_t interval, size_t snapshots)
+{
+    if (b && (interval == 0 || snapshots == 0))
+        throw std::out_of_range {"Gameboy: history needs a non-zero interval and size"};
+    const std::lock_guard<std::mutex> lock(mutex_);
+    history_.clear();
+    input_log_.clear();
+    history_size_ = b ? snapshots : 0;
+    history_interval_ = interval;
+    // the first snapshot is taken before the next instruction
+    next_snapshot_ = b ? elapsed_cycles_ : UINT64_MAX;
+}
+
+bool Gameboy::step_back()
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (movie_mode_ != Movie_mode::None)
+        return false;
+    const uint64_t target {elapsed_cycles_};
+    const Gameboy *snapshot {snapshot_before(target)};
+    if (!snapshot)
+        return false;
+    begin_replay();
+    try
+    {
+        // find where the instruction before target starts, then replay up to it
+        replay_from(*snapshot);
+        uint64_t previous {elapsed_cycles_};
+        while (elapsed_cycles_ < target)
+        {
+            previous = elapsed_cycles_;
+            replay_step();
+        }
+        replay_from(*snapshot);
+        while (elapsed_cycles_ < previous)
+            replay_step();
+    }
+    catch (...)
+    {
+        end_replay();
+        throw;
+    }
+    end_replay();
+    truncate_history();
+    // stepping forward again executes the instruction, even at a breakpoint
+    skip_breakpoint_ = breakpoints_.maybe(cpu_.pc());
+    return true;
+}
+
+bool Gameboy::reverse_continue()
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (movie_mode_ != Movie_mode::None || history_.empty())
+        return false;
+    const uint64_t target {elapsed_cycles_};
+    bool found {false};
+    begin_replay();
+    breakpoints_enabled_ = true;
+    try
+    {
+        // search the segments between snapshots from the newest back, replaying each to
+        // count the stops in it, then replay to the last stop of the first segment with one
+        uint64_t end {target};
+        for (auto s {history_.rbegin()}; s != history_.rend() && !found; ++s)
+        {
+            const Gameboy &snapshot {**s};
+            if (snapshot.elapsed_cycles_ >= end)
+                continue;
+            replay_from(snapshot);
+            size_t stops {0}, last {0};
+            while (elapsed_cycles_ < end)
+            {
+                replay_step();
+                if (debug_break_)
+                {
+                    ++stops;
+                    if (elapsed_cycles_ < end)
+                        last = stops;
+                    clear_stop();
+                }
+            }
+            if (last)
+            {
+                replay_from(snapshot);
+                for (size_t n {0}; n < last; )
+                {
+                    replay_step();
+                    if (debug_break_ && ++n < last)
+                        clear_stop();
+                }
+                found = true;
+            }
+            end = snapshot.elapsed_cycles_;
+        }
+        if (!found)
+            replay_from(*history_.front());
+    }
+    catch (...)
+    {
+        end_replay();
+        throw;
+    }
+    end_replay();
+    truncate_history();
+    if (found)
+        emu_paused_ = true;
+    return found;
+}
+
+void Gameboy::take_snapshot()
+{
+    next_snapshot_ = elapsed_cycles_ + history_interval_;
+    if (replaying_)
+        return;
+    std::unique_ptr<Gameboy> s {};
+    if (history_.size() >= history_size_)
+    {
+        s = std::move(history_.front());
+        history_.pop_front();
+    }
+    else
+    {
+        s = std::make_unique<Gameboy>();
+        s->write_save_on_exit_ = false;
+    }
+    s->copy_state(*this);
+    history_.push_back(std::move(s));
+    // input from before the oldest snapshot is never replayed
+    const uint64_t oldest {history_.front()->elapsed_cycles_};
+    input_log_.erase(input_log_.begin(),
+                     std::find_if(input_log_.begin(), input_log_.end(),
+                                  [oldest](const Movie::Input_event &e)
+                                  { return e.cycle >= oldest; }));
+}
+
+void Gameboy::truncate_history()
+{
+    while (!history_.empty() && history_.back()->elapsed_cycles_ > elapsed_cycles_)
+        history_.pop_back();
+    // input logged at the current cycle hasn't been applied yet
+    input_log_.erase(std::find_if(input_log_.begin(), input_log_.end(),
+                                  [this](const Movie::Input_event &e)
+                                  { return e.cycle >= elapsed_cycles_; }),
+                     input_log_.end());
+    next_snapshot_ = history_.empty() ? elapsed_cycles_
+                                      : history_.back()->elapsed_cycles_ + history_interval_;
+}
+
+const Gameboy *Gameboy::snapshot_before(uint64_t cycle) const
+{
+    for (auto s {history_.rbegin()}; s != history_.rend(); ++s)
+    {
+        if ((*s)->elapsed_cycles_ < cycle)
+            return s->get();
+    }
+    return nullptr;
+}
+
+void Gameboy::begin_replay()
+{
+    replaying_ = true;
+    replay_renderer_ = ppu_.renderer();
+    ppu_.set_renderer(nullptr);
+    replay_speaker_ = apu_.speaker();
+    apu_.set_speaker(nullptr);
+    replay_debug_mode_ = debug_mode_;
+    debug_mode_ = false;
+    replay_breakpoints_enabled_ = breakpoints_enabled_;
+    breakpoints_enabled_ = false;
+    replay_trace_ = std::move(cpu_trace_);
+    cpu_trace_.reset();
+    replay_paused_ = emu_paused_;
+    // replayed instructions were counted and profiled the first time they ran
+    replay_histogram_ = cpu_.counting() ? histogram_.get() : nullptr;
+    cpu_.set_histogram(nullptr);
+    replay_call_profiler_ = cpu_.call_profiler();
+    cpu_.set_call_profiler(nullptr);
+    ppu_.hold_output(true);
+}
+
+void Gameboy::end_replay()
+{
+    replaying_ = false;
+    ppu_.set_renderer(replay_renderer_);
+    apu_.set_speaker(std::move(replay_speaker_));
+    debug_mode_ = replay_debug_mode_;
+    breakpoints_enabled_ = replay_breakpoints_enabled_;
+    cpu_trace_ = std::move(replay_trace_);
+    // stops run into while replaying pause emulation
+    emu_paused_ = replay_paused_;
+    cpu_.set_histogram(replay_histogram_);
+    // the call stack it tracked is gone, it counts on from where replay stopped
+    if (replay_call_profiler_)
+        replay_call_profiler_->restart(cpu_.cycles());
+    cpu_.set_call_profiler(replay_call_profiler_);
+    ppu_.hold_output(false);
+}
+
+void Gameboy::replay_from(const Gameboy &snapshot)
+{
+    copy_state(snapshot);
+    clear_stop();
+    skip_breakpoint_ = false;
+    watch_pending_ = false;
+    replay_input_ = static_cast<size_t>(
+            std::find_if(input_log_.begin(), input_log_.end(),
+                         [&snapshot](const Movie::Input_event &e)
+                         { return e.cycle >= snapshot.elapsed_cycles_; })
+            - input_log_.begin());
+}
+
+void Gameboy::replay_step()
+{
+    for (; replay_input_ < input_log_.size()
+           && input_log_[replay_input_].cycle <= elapsed_cycles_; ++replay_input_)
+    {
+        const Movie::Input_event &e {input_log_[replay_input_]};
+        if (e.pressed)
+            joypad_.press(e.input);
+        else
+            joypad_.release(e.input);
+    }
+    step_instructions(1);
+}
+
+void Gameboy::clear_stop()
+{
+    debug_break_ = false;
+    watch_hit_.reset();
+}
+
+void Gameboy::copy_state(const Gameboy &other)
+{
+    // the components reference each other, so each copies its own state in place
+    memory_.copy_state(other.memory_);
+    cpu_.copy_state(other.cpu_);
+    ppu_.copy_state(other.ppu_);
+    timer_.copy_state(other.timer_);
+    joypad_.copy_state(other.joypad_);
+    apu_.copy_state(other.apu_);
+    serial_.copy_state(other.serial_);
+    rom_title_ = other.rom_title_;
+    rom_loaded_ = other.rom_loaded_;
+    cgb_mode_ = other.cgb_mode_;
+    force_dmg_ = other.force_dmg_;
+    save_dir_ = other.save_dir_;
+    elapsed_cycles_ = other.elapsed_cycles_;
+}
+
+// FNV-1a
+static uint64_t hash_bytes(uint64_t h, const uint8_t *p, size_t n)
+{
+    for (size_t i {0}; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+template <typename T>
+static uint64_t hash_value(uint64_t h, const T &x)
+{
+    return hash_bytes(h, reinterpret_cast<const uint8_t *>(&x), sizeof(x));
+}
+
+uint64_t Gameboy::state_hash() const
+{
+    uint64_t h {0xcbf29ce484222325};
+    // hash CPU registers field by field, Cpu_dump has padding
+    const Cpu_dump cpu {cpu_.dump()};
+    for (uint16_t r : {cpu.af, cpu.bc, cpu.de, cpu.hl, cpu.sp, cpu.pc})
+        h = hash_value(h, r);
+    h = hash_value(h, cpu.cycles);
+    h = hash_value(h, static_cast<uint8_t>(cpu.ime));
+    const Memory::Dump mem {memory_.dump_memory()};
+    for (const std::vector<uint8_t> &v : {mem.vram.dump(), mem.wram.dump()})
+        h = hash_bytes(h, v.data(), v.size());
+    h = hash_bytes(h, mem.oam.data(), mem.oam.size());
+    h = hash_bytes(h, mem.io.data(), mem.io.size());
+    h = hash_bytes(h, mem.hram.data(), mem.hram.size());
+    h = hash_value(h, mem.ie);
+    // Ppu::Dump only holds bytes, so it has no padding
+    h = hash_value(h, ppu_.dump_values());
+    // the timer keeps its registers itself, not in io
+    h = hash_value(h, timer_.system_counter());
+    for (uint16_t adr {0xff05}; adr <= 0xff07; ++adr)
+        h = hash_value(h, timer_.read(adr));
+    // cartridge RAM and the banks the MBC maps
+    if (const Cartridge *cart {memory_.cartridge()})
+    {
+        if (const External_ram *ram {cart->ram()})
+        {
+            const std::vector<uint8_t> v {ram->dump()};
+            h = hash_bytes(h, v.data(), v.size());
+        }
+    }
+    h = hash_value(h, memory_.bank(0x4000));
+    h = hash_value(h, memory_.bank(0xa000));
+    return h;
 }
 
 void Gameboy::set_throttle(bool b)
@@ -204,11 +756,27 @@ void Gameboy::set_force_dmg(bool b)
     force_dmg_ = b;
 }
 
+void Gameboy::set_serial_callback(Serial::Transfer_callback cb)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    serial_.set_transfer_callback(std::move(cb));
+}
+
+uint8_t Gameboy::link_transfer(uint8_t b)
+{
+    return serial_.external_transfer(b);
+}
+
 size_t Gameboy::cycles() const
 {
     return cpu_.cycles();
 }
 
+uint64_t Gameboy::elapsed_cycles() const
+{
+    return elapsed_cycles_;
+}
+
 bool Gameboy::is_cgb() const
 {
     return cgb_mode_;
@@ -220,24 +788,258 @@ bool Gameboy::is_running() const
     return !emu_paused_;
 }
 
-// passed as callback function to CPU
 uint8_t Gameboy::memory_read(uint16_t adr)
 {
     return memory_.read(adr);
 }
 
-// passed as callback function to CPU
 void Gameboy::memory_write(uint8_t b, uint16_t adr)
 {
     memory_.write(b, adr);
 }
 
+// passed as callback function to CPU
+uint8_t Gameboy::bus_read(uint16_t adr)
+{
+    // instruction fetches are Execute accesses, not Read ones
+    if (watchpoints_.trapped(adr, Watchpoints::Read) && !cpu_.fetching())
+        watch(adr, memory_read(adr), Watchpoints::Read);
+    if (!profiling_)
+        return memory_read(adr);
+    profiler_->enter(Profiler::Component::Memory);
+    const uint8_t b {memory_read(adr)};
+    profiler_->leave();
+    return b;
+}
+
+// passed as callback function to CPU
+void Gameboy::bus_write(uint8_t b, uint16_t adr)
+{
+    if (watchpoints_.trapped(adr, Watchpoints::Write))
+        watch(adr, b, Watchpoints::Write);
+    if (adr >= 0xff00 && (adr < 0xff80 || adr == 0xffff)) // IO registers and IE
+        flight_recorder_.record_io(instruction_pc_, adr, b);
+    if (!profiling_)
+    {
+        memory_write(b, adr);
+        return;
+    }
+    profiler_->enter(Profiler::Component::Memory);
+    memory_write(b, adr);
+    profiler_->leave();
+}
+
+void Gameboy::write_crash_dump(const std::exception &e) const
+{
+    if (crash_dump_path_.empty())
+        return;
+    std::ofstream out {crash_dump_path_};
+    out << "Emulation failed: " << e.what();
+    if (const auto *ex = dynamic_cast<const Exception *>(&e))
+        out << " (" << ex->file() << ':' << ex->line() << ')';
+    out << "\nLast instructions, oldest first:\n";
+    flight_recorder_.dump(out);
+    if (out)
+        std::cout << "Flight recorder written to " << crash_dump_path_ << ".\n";
+}
+
+void Gameboy::watch(uint16_t adr, uint8_t b, Watchpoints::Access access)
+{
+    // the first access an instruction makes to a watched address is the one reported
+    if (!breakpoints_enabled_ || watch_pending_)
+        return;
+    const Watchpoints::Watchpoint *w {watchpoints_.match(adr, memory_.bank(adr), access,
+                                                         cpu_, memory_)};
+    if (w)
+    {
+        watch_hit_ = Watchpoints::Hit {w->id, adr, b, access, instruction_pc_};
+        watch_pending_ = true;
+    }
+}
+
+void Gameboy::set_profiling(bool b)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (b)
+        profiler_ = std::make_unique<Profiler>();
+    profiling_ = b;
+    ppu_.set_profiler(b ? profiler_.get() : nullptr);
+}
+
+bool Gameboy::profiling() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return profiling_;
+}
+
+const Profiler *Gameboy::profiler() const
+{
+    return profiler_.get();
+}
+
+void Gameboy::set_execution_histogram(bool b)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!b)
+    {
+        cpu_.set_histogram(nullptr);
+        return;
+    }
+    const Cartridge *cart {memory_.cartridge()};
+    if (!cart)
+        throw std::runtime_error {"set_execution_histogram: no ROM loaded"};
+    histogram_ = std::make_unique<Execution_histogram>(cart->rom().banks());
+    cpu_.set_histogram(histogram_.get());
+}
+
+const Execution_histogram *Gameboy::execution_histogram() const
+{
+    return histogram_.get();
+}
+
+void Gameboy::set_coverage(bool b)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!b)
+    {
+        cpu_.set_coverage(nullptr);
+        return;
+    }
+    const Cartridge *cart {memory_.cartridge()};
+    if (!cart)
+        throw std::runtime_error {"set_coverage: no ROM loaded"};
+    coverage_ = std::make_unique<Coverage>(cart->rom().banks());
+    cpu_.set_coverage(coverage_.get());
+}
+
+Coverage *Gameboy::coverage()
+{
+    return coverage_.get();
+}
+
+const Coverage *Gameboy::coverage() const
+{
+    return coverage_.get();
+}
+
+void Gameboy::set_call_profiling(bool b)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!b)
+    {
+        cpu_.set_call_profiler(nullptr);
+        return;
+    }
+    call_profiler_ = std::make_unique<Call_profiler>();
+    cpu_.set_call_profiler(call_profiler_.get());
+}
+
+const Call_profiler *Gameboy::call_profiler() const
+{
+    return call_profiler_.get();
+}
+
 void Gameboy::set_debug_mode(bool b)
 {
     debug_mode_ = b;
     memory_.set_debug_mode(b);
 }
 
+void Gameboy::add_breakpoint(uint16_t adr, int bank, const std::string &condition)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    breakpoints_.add(adr, bank, condition);
+}
+
+void Gameboy::delete_breakpoint(uint16_t adr, int bank)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    breakpoints_.remove(adr, bank);
+}
+
+std::vector<Breakpoints::Breakpoint> Gameboy::breakpoints() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return breakpoints_.list();
+}
+
+void Gameboy::enable_breakpoints(bool b)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    breakpoints_enabled_ = b;
+}
+
+bool Gameboy::at_breakpoint() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return debug_break_ && skip_breakpoint_;
+}
+
+int Gameboy::add_watchpoint(uint16_t first, uint16_t last, uint8_t access, int bank,
+                            const std::string &condition)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return watchpoints_.add(first, last, access, bank, condition);
+}
+
+void Gameboy::delete_watchpoint(int id)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    watchpoints_.remove(id);
+}
+
+std::vector<Watchpoints::Watchpoint> Gameboy::watchpoints() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return watchpoints_.list();
+}
+
+std::optional<Watchpoints::Hit> Gameboy::watchpoint_hit() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return watch_hit_;
+}
+
+void Gameboy::set_cpu_trace(std::shared_ptr<Cpu_trace> trace)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    cpu_trace_ = std::move(trace);
+}
+
+std::shared_ptr<Cpu_trace> Gameboy::cpu_trace() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return cpu_trace_;
+}
+
+void Gameboy::dump_flight_recorder(std::ostream &os) const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    flight_recorder_.dump(os);
+}
+
+void Gameboy::set_crash_dump_path(const std::string &path)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    crash_dump_path_ = path;
+}
+
+Cpu_trace::Record Gameboy::trace_record() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return make_trace_record();
+}
+
+Cpu_trace::Record Gameboy::make_trace_record() const
+{
+    // read around the CPU bus so tracing doesn't trigger watchpoints
+    const uint16_t pc {cpu_.pc()};
+    return {cpu_.af(), cpu_.bc(), cpu_.de(), cpu_.hl(), cpu_.sp(), pc, memory_.bank(pc),
+            {memory_.read(pc), memory_.read(static_cast<uint16_t>(pc + 1)),
+             memory_.read(static_cast<uint16_t>(pc + 2))},
+            memory_.read(0xff44), cpu_.ime(), 0, cpu_.cycles()};
+}
+
 void Gameboy::set_cpu_debug_callback(std::function<bool()> fn)
 {
     cpu_debug_callback_ = std::move(fn);
@@ -253,6 +1055,16 @@ std::unordered_map<std::string, Memory_range> Gameboy::dump_mapped_memory() cons
     return memory_.dump_mapped();
 }
 
+void Gameboy::dump_mapped_memory(uint16_t first, std::size_t n, uint8_t *out) const
+{
+    memory_.dump_mapped(first, n, out);
+}
+
+std::string Gameboy::mapped_region_name(uint16_t adr) const
+{
+    return memory_.mapped_name(adr);
+}
+
 std::vector<Memory_byte> Gameboy::dump_memory_log()
 {
     const std::lock_guard<std::mutex> lock(mutex_);
@@ -264,6 +1076,17 @@ std::vector<uint8_t> Gameboy::dump_rom() const
     return memory_.dump_rom();
 }
 
+const Rom *Gameboy::rom() const
+{
+    const Cartridge *cart {memory_.cartridge()};
+    return cart ? &cart->rom() : nullptr;
+}
+
+uint16_t Gameboy::mapped_bank(uint16_t adr) const
+{
+    return memory_.bank(adr);
+}
+
 Cpu_dump Gameboy::dump_cpu() const
 {
     const std::lock_guard<std::mutex> lock(mutex_);
@@ -3,54 +3,78 @@
 
 using qtboy::Timer;
 
-Timer::Timer(Processor &p)
-    : cpu_ {p}
+Timer::Timer(Processor &p, const uint64_t &clock)
+    : cpu_ {p}, clock_ {clock}
 {}
 
-void Timer::update(std::size_t cycles)
+void Timer::copy_state(const Timer &other)
 {
-    div_ticks_ += cycles;
-    if (div_ticks_ >= 0xff)
+    counter_offset_ = other.counter_offset_;
+    tima_counter_ = other.tima_counter_;
+    next_overflow_ = other.next_overflow_;
+    tima_ = other.tima_;
+    tma_ = other.tma_;
+    tac_ = other.tac_;
+}
+
+uint64_t Timer::ticks(uint64_t from, uint64_t to) const
+{
+    // one tick per falling edge of the selected bit = per multiple of the period crossed
+    return enabled() ? to / period() - from / period() : 0;
+}
+
+void Timer::sync()
+{
+    const uint64_t now {counter()};
+    // no overflow is due before next_overflow_, so this can't wrap past 0xff
+    tima_ = static_cast<uint8_t>(tima_ + ticks(tima_counter_, now));
+    tima_counter_ = now;
+}
+
+void Timer::predict()
+{
+    if (!enabled())
     {
-        div_ticks_ -= 0xff;
-        ++div_;
+        next_overflow_ = UINT64_MAX;
+        return;
     }
+    // counter value of the falling edge that takes TIMA from 0xff to 0
+    const uint64_t edge {(tima_counter_ / period() + (0x100 - tima_)) * period()};
+    next_overflow_ = edge - counter_offset_;
+}
 
-    // bit 2 is enable bit
-    // bit 0-1 determine update frequency
-    if (tac_ & 4)
+void Timer::update()
+{
+    while (clock_ >= next_overflow_)
     {
-        tima_ticks_ += cycles;
-        int freq = FREQUENCIES[tac_ & 3];
-        while (tima_ticks_ >= freq)
-        {
-            tima_ticks_ -= freq;
-            ++tima_;
-            if (tima_ == 0)
-            {
-                tima_overflow();
-            }
-        }
+        tima_counter_ = next_overflow_ + counter_offset_;
+        overflow();
+        predict();
     }
-
 }
 
-void Timer::tima_overflow()
+void Timer::overflow()
 {
     tima_ = tma_;
     cpu_.request_interrupt(Processor::TIMER);
 }
 
-uint8_t Timer::read(uint16_t adr)
+void Timer::increment()
+{
+    if (++tima_ == 0)
+        overflow();
+}
+
+uint8_t Timer::read(uint16_t adr) const
 {
     uint8_t b {0xff};
     switch (adr)
     {
-        case 0xff04: // DIV
-            b = (div_ >> 8); // only upper 8-bits
+        case 0xff04: // DIV: upper 8 bits of the system counter
+            b = static_cast<uint8_t>(counter() >> 8);
             break;
         case 0xff05: // TIMA
-            b = tima_;
+            b = static_cast<uint8_t>(tima_ + ticks(tima_counter_, counter()));
             break;
         case 0xff06: // TMA
             b = tma_;
@@ -64,10 +88,17 @@ uint8_t Timer::read(uint16_t adr)
 
 void Timer::write(uint8_t b, uint16_t adr)
 {
+    sync();
+    const uint64_t now {counter()};
+    // TIMA increments on a falling edge of (selected counter bit AND timer enable)
+    const bool signal {enabled() && (now & (period() >> 1))};
     switch (adr)
     {
-        case 0xff04: // DIV
-            div_ = 0;
+        case 0xff04: // DIV: resets the whole system counter
+            if (signal)
+                increment();
+            counter_offset_ = 0 - clock_;
+            tima_counter_ = 0;
             break;
         case 0xff05: // TIMA
             tima_ = b;
@@ -76,17 +107,23 @@ void Timer::write(uint8_t b, uint16_t adr)
             tma_ = b;
             break;
         case 0xff07: // TAC
+        {
             tac_ = b;
-            break;
+            const bool new_signal {enabled() && (now & (period() >> 1))};
+            if (signal && !new_signal)
+                increment();
+        } break;
     }
+    predict();
 }
 
 void Timer::reset()
 {
-    div_ticks_ = 0;
-    tima_ticks_ = 0;
+    // the owner resets the clock to 0 as well, so the counter restarts at 0
+    counter_offset_ = 0;
+    tima_counter_ = 0;
+    next_overflow_ = UINT64_MAX;
     tima_ = 0;
     tma_ = 0;
     tac_ = 0;
-    div_ = 0;
 }
@@ -0,0 +1,66 @@
+#include "watchpoints.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qtboy
+{
+
+int Watchpoints::add(uint16_t first, uint16_t last, uint8_t access, int bank,
+                     const std::string &condition)
+{
+    if (first > last)
+        throw std::out_of_range {"Watchpoints: first address after last"};
+    if (bank < ANY_BANK || bank > 0xffff)
+        throw std::out_of_range {"Watchpoints: bank out of range"};
+    conditions_.emplace_back(condition);
+    watchpoints_.push_back({next_id_, first, last,
+                            static_cast<uint8_t>(access & (Read | Write | Execute)), bank,
+                            condition});
+    update_pages();
+    return next_id_++;
+}
+
+void Watchpoints::remove(int id)
+{
+    const auto i {std::find_if(watchpoints_.begin(), watchpoints_.end(),
+                               [id](const Watchpoint &w) { return w.id == id; })};
+    if (i == watchpoints_.end())
+        return;
+    conditions_.erase(conditions_.begin() + (i - watchpoints_.begin()));
+    watchpoints_.erase(i);
+    update_pages();
+}
+
+void Watchpoints::clear()
+{
+    watchpoints_.clear();
+    conditions_.clear();
+    pages_ = {};
+}
+
+const Watchpoints::Watchpoint *Watchpoints::match(uint16_t adr, uint16_t bank,
+                                                  Access access, const Processor &cpu,
+                                                  const Memory &memory) const
+{
+    for (std::size_t i = 0; i < watchpoints_.size(); ++i)
+    {
+        const Watchpoint &w {watchpoints_[i]};
+        if ((w.access & access) && adr >= w.first && adr <= w.last
+                && (w.bank == ANY_BANK || w.bank == bank) && conditions_[i](cpu, memory))
+            return &w;
+    }
+    return nullptr;
+}
+
+void Watchpoints::update_pages()
+{
+    pages_ = {};
+    for (const Watchpoint &w : watchpoints_)
+    {
+        for (unsigned page = w.first >> 8; page <= unsigned {w.last} >> 8; ++page)
+            pages_[page] |= w.access;
+    }
+}
+
+}
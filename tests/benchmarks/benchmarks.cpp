@@ -0,0 +1,354 @@
+// Microbenchmarks for the emulator's hot paths. Every benchmark prints one JSON object per
+// line so results can be collected and compared between commits:
+//   {"benchmark": "...", "iterations": n, "ns_per_op": x, "items_per_second": y}
+// An op is one call of the measured code, items are what the op processes (bytes,
+// instructions, scanlines, seconds of audio).
+//
+// usage: benchmarks [--filter substring] [--min-time seconds] [--rom path]
+//   --filter    only run benchmarks whose name contains substring
+//   --min-time  time each benchmark runs for at least (0.5)
+//   --rom       ROM to disassemble (a synthetic 32 KB ROM by default)
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "apu.hpp"
+#include "coverage.hpp"
+#include "disassembler.hpp"
+#include "disassembly_cache.hpp"
+#include "joypad.hpp"
+#include "memory.hpp"
+#include "ppu.hpp"
+#include "processor.hpp"
+#include "renderer.hpp"
+#include "rom.hpp"
+#include "serial.hpp"
+#include "speaker.hpp"
+#include "timer.hpp"
+
+using namespace qtboy;
+
+static std::string filter {};
+static double min_time {0.5};
+
+// keeps the optimizer from discarding results
+static volatile uint64_t sink {0};
+
+// Run op in growing batches until it has run for min_time, then report it.
+static void bench(const std::string &name, double items_per_op, const std::function<void()> &op)
+{
+    if (name.find(filter) == std::string::npos)
+        return;
+    using clock = std::chrono::steady_clock;
+    uint64_t iterations {0};
+    double elapsed {0};
+    for (uint64_t batch {1}; elapsed < min_time; batch *= 2)
+    {
+        const auto start = clock::now();
+        for (uint64_t i {0}; i < batch; ++i)
+            op();
+        elapsed += std::chrono::duration<double>(clock::now() - start).count();
+        iterations += batch;
+    }
+    std::cout << "{\"benchmark\": \"" << name << "\", \"iterations\": " << iterations
+              << ", \"ns_per_op\": " << elapsed * 1e9 / iterations
+              << ", \"items_per_second\": " << iterations * items_per_op / elapsed << "}\n";
+}
+
+// 32 KB ROM with an MBC1, 8 KB of RAM and no battery (so nothing is saved)
+static Rom make_rom(std::mt19937 &rng)
+{
+    std::string bytes(0x8000, '\0');
+    for (char &c : bytes)
+        c = static_cast<char>(rng());
+    bytes[0x143] = 0; // DMG
+    bytes[0x147] = 0x02; // MBC1+RAM
+    bytes[0x148] = 0x00; // 32 KB
+    bytes[0x149] = 0x02; // 8 KB RAM
+    std::istringstream is {bytes};
+    return Rom {is};
+}
+
+// The components wired together the same way Gameboy does, without the threading.
+struct Machine
+{
+    uint64_t clock {0};
+    Processor cpu
+    {
+        [this](uint16_t adr) { return memory.read(adr); },
+        [this](uint8_t b, uint16_t adr) { memory.write(b, adr); }
+    };
+    Ppu ppu {memory, cpu};
+    Timer timer {cpu, clock};
+    Joypad joypad {cpu};
+    Apu apu {};
+    Serial serial {cpu};
+    Memory memory {cpu, ppu, timer, joypad, apu, serial};
+};
+
+struct Null_renderer : Renderer
+{
+    void draw_texture(const Texture &t, unsigned, unsigned) override { sink += t.pixel(0); }
+    void present_screen() override {}
+};
+
+struct Null_speaker : Speaker
+{
+    void queue_samples(const Raw_audio &a) override { sink += a.size(); }
+    int samples_queued() override { return 0; }
+    void clear_samples() override {}
+};
+
+static void memory_benchmarks(std::mt19937 &rng)
+{
+    Machine m;
+    m.memory.load_cartridge(make_rom(rng));
+    m.memory.write(0x0a, 0x0000); // enable cartridge RAM
+    struct Region { const char *name; uint16_t base, size; };
+    const Region regions[]
+    {
+        {"rom0", 0x0000, 0x4000}, {"romx", 0x4000, 0x4000}, {"vram", 0x8000, 0x2000},
+        {"eram", 0xa000, 0x2000}, {"wram", 0xc000, 0x2000}, {"oam", 0xfe00, 0xa0},
+        {"io", 0xff00, 0x80}, {"hram", 0xff80, 0x7f},
+    };
+    for (const Region &r : regions)
+    {
+        uint16_t i {0};
+        bench(std::string {"memory_read/"} + r.name, 1, [&] {
+            sink += m.memory.read(static_cast<uint16_t>(r.base + i));
+            if (++i == r.size)
+                i = 0;
+        });
+    }
+    for (const Region &r : regions)
+    {
+        // ROM writes are MBC register writes, IO writes would start DMAs and the like
+        if (r.base < 0x8000 || r.base == 0xff00)
+            continue;
+        uint16_t i {0};
+        bench(std::string {"memory_write/"} + r.name, 1, [&] {
+            m.memory.write(static_cast<uint8_t>(i), static_cast<uint16_t>(r.base + i));
+            if (++i == r.size)
+                i = 0;
+        });
+    }
+}
+
+// A flat 64 KB address space running block over and over from 0x100, marking coverage if
+// given.
+static void cpu_benchmark(const std::string &name, const std::vector<uint8_t> &block,
+                          const std::vector<std::pair<uint16_t, std::vector<uint8_t>>> &extra = {},
+                          Coverage *coverage = nullptr)
+{
+    std::vector<uint8_t> mem(0x10000, 0);
+    uint16_t pc {0x100};
+    while (pc + block.size() + 3 < 0x4000)
+    {
+        std::copy(block.begin(), block.end(), mem.begin() + pc);
+        pc += static_cast<uint16_t>(block.size());
+    }
+    // jump back to the start
+    mem[pc] = 0xc3;
+    mem[pc + 1] = 0x00;
+    mem[pc + 2] = 0x01;
+    for (const auto &[adr, code] : extra)
+        std::copy(code.begin(), code.end(), mem.begin() + adr);
+    Processor cpu
+    {
+        [&mem](uint16_t adr) { return mem[adr]; },
+        [&mem](uint8_t b, uint16_t adr) { mem[adr] = b; }
+    };
+    cpu.set_coverage(coverage);
+    bench("cpu_step/" + name, 1, [&] { cpu.step(); });
+    sink += cpu.cycles();
+}
+
+static void cpu_benchmarks()
+{
+    cpu_benchmark("nop", {0x00});
+    cpu_benchmark("alu", {
+        0x80, // add a,b
+        0xa9, // xor c
+        0x14, // inc d
+        0x1d, // dec e
+        0xe6, 0x0f, // and $0f
+        0xfe, 0x10, // cp $10
+        0x8c, // adc a,h
+        0x95, // sub l
+        0x09, // add hl,bc
+        0x27, // daa
+    });
+    const std::vector<uint8_t> load_store {
+        0x21, 0x00, 0xc0, // ld hl,$c000
+        0x77, // ld (hl),a
+        0x7e, // ld a,(hl)
+        0x41, // ld b,c
+        0x22, // ld (hl+),a
+        0x3a, // ld a,(hl-)
+        0xc5, // push bc
+        0xc1, // pop bc
+        0xea, 0x10, 0xc0, // ld ($c010),a
+        0xe0, 0x80, // ldh ($80),a
+    };
+    cpu_benchmark("load_store", load_store);
+    Coverage coverage {2};
+    cpu_benchmark("load_store/coverage", load_store, {}, &coverage);
+    cpu_benchmark("cb", {
+        0xcb, 0x7f, // bit 7,a
+        0xcb, 0x00, // rlc b
+        0xcb, 0x31, // swap c
+        0xcb, 0xda, // set 3,d
+        0xcb, 0x8b, // res 1,e
+        0xcb, 0x3c, // srl h
+    });
+    cpu_benchmark("branch", {
+        0xcd, 0x00, 0x40, // call $4000
+        0x18, 0x00, // jr +0
+        0x20, 0x00, // jr nz,+0
+        0xc2, 0x00, 0x00, // jp nz,$0000 (not taken, z is set by the last compare)
+        0xbf, // cp a
+    }, {{0x4000, {0xc9}}}); // ret
+}
+
+// Render one frame (144 scanlines plus VBLANK) through Ppu::step.
+static void ppu_benchmark(const std::string &name, std::mt19937 &rng, uint8_t lcdc,
+                          bool sprites, Ppu::Output output = Ppu::Output::Rgb)
+{
+    Machine m;
+    Null_renderer renderer;
+    m.memory.load_cartridge(make_rom(rng));
+    m.ppu.set_renderer(&renderer);
+    if (output != Ppu::Output::Rgb)
+        m.ppu.set_output(output, 84, 84);
+    // random tiles and tile maps
+    for (uint16_t adr {0x8000}; adr < 0xa000; ++adr)
+        m.memory.write(static_cast<uint8_t>(rng()), adr);
+    for (uint8_t i {0}; i < 40; ++i)
+    {
+        // 4 bands of 16 lines with 10 8x16 sprites on each line
+        const uint16_t oam = 0xfe00 + i * 4;
+        m.memory.write(sprites ? static_cast<uint8_t>(16 + (i / 10) * 36) : 0, oam);
+        m.memory.write(static_cast<uint8_t>(8 + (i % 10) * 16), oam + 1);
+        m.memory.write(static_cast<uint8_t>(rng()), oam + 2);
+        m.memory.write(static_cast<uint8_t>(i & 0x90), oam + 3);
+    }
+    m.memory.write(0x07, 0xff4b); // WX
+    m.memory.write(0x00, 0xff4a); // WY
+    m.memory.write(lcdc, 0xff40);
+    bench("ppu_frame/" + name, 144, [&] {
+        for (int line {0}; line < 154; ++line)
+        {
+            m.ppu.step(80);
+            m.ppu.step(172);
+            m.ppu.step(204);
+        }
+    });
+}
+
+static void ppu_benchmarks(std::mt19937 &rng)
+{
+    // items are scanlines
+    ppu_benchmark("bg", rng, 0x91, false);
+    ppu_benchmark("bg_window", rng, 0xf1, false);
+    ppu_benchmark("bg_sprites", rng, 0x97, true);
+    ppu_benchmark("bg_window_sprites", rng, 0xf7, true);
+    ppu_benchmark("bg_window_sprites_luminance_84x84", rng, 0xf7, true, Ppu::Output::Luminance);
+}
+
+static void apu_benchmark()
+{
+    Apu apu;
+    apu.set_speaker(std::make_shared<Null_speaker>());
+    // all four channels on and playing
+    const std::pair<uint16_t, uint8_t> regs[]
+    {
+        {0xff26, 0x80}, {0xff24, 0x77}, {0xff25, 0xff},
+        {0xff11, 0x80}, {0xff12, 0xf0}, {0xff13, 0x00}, {0xff14, 0x87},
+        {0xff16, 0x80}, {0xff17, 0xf0}, {0xff18, 0x00}, {0xff19, 0x87},
+        {0xff1a, 0x80}, {0xff1c, 0x20}, {0xff1d, 0x00}, {0xff1e, 0x87},
+        {0xff21, 0xf0}, {0xff22, 0x11}, {0xff23, 0x80},
+    };
+    for (const auto &[adr, b] : regs)
+        apu.write_reg(b, adr);
+    // one second of audio, ticked 4 cycles (one instruction's worth) at a time
+    bench("apu_tick/1s_audio", 1, [&] {
+        for (int i {0}; i < 4194304 / 4; ++i)
+            apu.tick(4);
+    });
+}
+
+static void disassembler_benchmark(const std::string &path, std::mt19937 &rng)
+{
+    Rom image;
+    if (!path.empty())
+    {
+        std::ifstream is {path, std::ios::binary};
+        if (!is)
+        {
+            std::cerr << "Could not open " << path << '\n';
+            return;
+        }
+        image = Rom {is};
+    }
+    else
+    {
+        image = make_rom(rng);
+    }
+    std::vector<uint8_t> rom {image.dump()};
+    // the last instruction could run past the end
+    rom.resize(rom.size() + 2, 0);
+    bench("disassemble/rom", static_cast<double>(rom.size()), [&] {
+        sink += Disassembler::disassemble(rom).size();
+    });
+    bench("disassemble/pretty", static_cast<double>(rom.size()), [&] {
+        sink += Disassembler::pretty_disassemble(rom).size();
+    });
+    // text only, into one buffer
+    bench("disassemble/format", static_cast<double>(rom.size()), [&] {
+        char text[Disassembler::MAX_TEXT];
+        for (size_t i {0}; i + 2 < rom.size(); i += instructions[rom[i]].length)
+            sink += Disassembler::format({rom[i], rom[i + 1], rom[i + 2]}, i, text);
+    });
+    // a fresh cache decoding from the vectors, then listing what it found
+    bench("disassemble/cache", 1, [&] {
+        Disassembly_cache cache {[](uint16_t){ return uint8_t {0xff}; },
+                                 [](uint16_t){ return uint16_t {1}; }};
+        cache.set_rom(image);
+        sink += cache.lines().size();
+    });
+}
+
+int main(int argc, char **argv)
+{
+    std::string rom_path {};
+    for (int i {1}; i < argc; ++i)
+    {
+        const std::string arg {argv[i]};
+        if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc)
+            min_time = std::stod(argv[++i]);
+        else if (arg == "--rom" && i + 1 < argc)
+            rom_path = argv[++i];
+        else
+        {
+            std::cerr << "usage: benchmarks [--filter substring] [--min-time seconds] [--rom path]\n";
+            return -1;
+        }
+    }
+    // fixed seed so every run measures the same data
+    std::mt19937 rng {1};
+    memory_benchmarks(rng);
+    cpu_benchmarks();
+    ppu_benchmarks(rng);
+    apu_benchmark();
+    disassembler_benchmark(rom_path, rng);
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Runs every test ROM in a directory headless and in parallel, and reads the result each
+// ROM prints over the serial port (Blargg's tests print "Passed" or "Failed").
+//
+// usage: conformance_runner [rom directory] [--seconds n] [--jobs n]
+//   rom directory  defaults to ../../roms/tests
+//   --seconds n    emulated seconds each ROM may run before it counts as timed out (60)
+//   --jobs n       ROMs run at once (one per core)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "system.hpp"
+
+namespace fs = std::filesystem;
+
+enum class Status { Passed, Failed, Timeout, Error };
+
+struct Result
+{
+    std::string name;
+    Status status {Status::Timeout};
+    uint64_t cycles {0};
+    double seconds {0};
+    std::string output {};
+};
+
+static constexpr uint64_t CPU_HZ {4194304};
+static constexpr uint64_t FRAME_CYCLES {70224};
+
+static void run_rom(const fs::path &path, uint64_t budget, Result &r)
+{
+    qtboy::Gameboy g;
+    if (!g.load_cartridge(path.string()))
+    {
+        r.status = Status::Error;
+        return;
+    }
+    // nothing is connected to the serial port, capture what the ROM sends
+    g.set_serial_callback([&r](uint8_t b) {
+        r.output += static_cast<char>(b);
+        return static_cast<uint8_t>(0xff);
+    });
+    const auto start = std::chrono::steady_clock::now();
+    while (g.elapsed_cycles() < budget)
+    {
+        g.execute(FRAME_CYCLES);
+        if (r.output.find("Passed") != std::string::npos)
+        {
+            r.status = Status::Passed;
+            break;
+        }
+        if (r.output.find("Failed") != std::string::npos)
+        {
+            r.status = Status::Failed;
+            break;
+        }
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.cycles = g.elapsed_cycles();
+}
+
+static const char *status_name(Status s)
+{
+    switch (s)
+    {
+        case Status::Passed: return "PASS";
+        case Status::Failed: return "FAIL";
+        case Status::Timeout: return "TIMEOUT";
+        default: return "ERROR";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    fs::path dir {"../../roms/tests"};
+    uint64_t seconds {60};
+    unsigned jobs {std::max(1u, std::thread::hardware_concurrency())};
+    for (int i {1}; i < argc; ++i)
+    {
+        const std::string arg {argv[i]};
+        if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::stoull(argv[++i]);
+        else if (arg == "--jobs" && i + 1 < argc)
+            jobs = std::max(1, std::stoi(argv[++i]));
+        else
+            dir = arg;
+    }
+
+    std::vector<fs::path> roms;
+    try
+    {
+        for (const fs::directory_entry &e : fs::directory_iterator {dir})
+        {
+            const std::string ext {e.path().extension().string()};
+            if (e.is_regular_file() && (ext == ".gb" || ext == ".gbc"))
+                roms.push_back(e.path());
+        }
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Could not read " << dir << ": " << e.what() << '\n';
+        return -1;
+    }
+    std::sort(roms.begin(), roms.end());
+
+    // workers take the next ROM until all are done
+    std::vector<Result> results(roms.size());
+    std::atomic<size_t> next {0};
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned w {0}; w < std::min<size_t>(jobs, roms.size()); ++w)
+    {
+        workers.emplace_back([&] {
+            for (size_t i; (i = next++) < roms.size();)
+            {
+                results[i].name = roms[i].filename().string();
+                try
+                {
+                    run_rom(roms[i], seconds * CPU_HZ, results[i]);
+                }
+                catch (const std::exception &e)
+                {
+                    results[i].status = Status::Error;
+                    results[i].output = e.what();
+                }
+            }
+        });
+    }
+    for (std::thread &t : workers)
+        t.join();
+    const double total {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    int passed {0};
+    for (const Result &r : results)
+    {
+        const double mhz {r.seconds > 0 ? r.cycles / r.seconds / 1e6 : 0};
+        std::cout << std::left << std::setw(8) << status_name(r.status)
+                  << std::setw(28) << r.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(8) << mhz << " MHz  "
+                  << std::setprecision(2) << std::setw(7) << r.cycles / double(CPU_HZ) << " s emulated";
+        if (r.status == Status::Error)
+            std::cout << "  " << (r.output.empty() ? "could not load ROM" : r.output);
+        std::cout << '\n';
+        passed += r.status == Status::Passed;
+    }
+    std::cout << passed << '/' << results.size() << " passed in " << std::setprecision(2)
+              << total << " s on " << std::min<size_t>(jobs, roms.size()) << " threads\n";
+    return passed == static_cast<int>(results.size()) ? 0 : 1;
+}
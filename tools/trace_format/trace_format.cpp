@@ -0,0 +1,49 @@
+// Formats a binary CPU trace (see Cpu_trace) as the text log written by Debugger, one line
+// per instruction, oldest first.
+//
+// usage: trace_format trace-file [output-file]
+//   output goes to stdout if no output file is given
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cpu_trace.hpp"
+
+using namespace qtboy;
+
+static void write_trace(const std::vector<Cpu_trace::Record> &records, std::ostream &out)
+{
+    for (const Cpu_trace::Record &r : records)
+        out << Cpu_trace::format(r) << '\n';
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " trace-file [output-file]\n";
+        return 2;
+    }
+    try
+    {
+        const std::vector<Cpu_trace::Record> records {Cpu_trace::load(argv[1])};
+        if (argc == 2)
+        {
+            write_trace(records, std::cout);
+            return 0;
+        }
+        std::ofstream out {argv[2]};
+        if (!out)
+            throw std::runtime_error {std::string {"could not open "} + argv[2]};
+        write_trace(records, out);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << argv[0] << ": " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}